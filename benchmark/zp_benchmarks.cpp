@@ -20,7 +20,14 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 ******************************************************************************/
 #include <benchmark/benchmark.h>
+#include <memory>
 #include <random>
+#include <vector>
+#include <zp_eliminator/batched.hpp>
+#include <zp_eliminator/convert.hpp>
+#include <zp_eliminator/echelon.hpp>
+#include <zp_eliminator/pluq.hpp>
+#include <zp_eliminator/random.hpp>
 #include <zp_eliminator/vector_kernels.hpp>
 #include <zp_eliminator/zp_scalar.hpp>
 
@@ -111,17 +118,386 @@ template <MulAlgo algo> static void Z32749_Mul(bm::State &state) {
       bm::DoNotOptimize(a[i].operator*<algo>(b[i]));
   }
 };
+static void Z32749_MulVec(bm::State &state) {
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  ZP a[N], b[N], c[N];
+  for (int i = 0; i < N; ++i) {
+    a[i] = runif(rng);
+    b[i] = runif(rng);
+  }
+
+  for (auto _ : state) {
+    VecMulOp<uint16_t, 16, P>::run(a, b, c, N);
+    bm::DoNotOptimize(c);
+    bm::ClobberMemory();
+  }
+};
+
+// Solves 16384 independent n x n systems with a single right-hand side
+static void Z32749_BatchedSolve(bm::State &state) {
+  const int n = state.range(0);
+  const size_t count = 16384;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  BatchedMatrices<P> A(count, n, n), B(count, n, 1);
+  for (size_t i = 0; i < count; ++i)
+    for (int r = 0; r < n; ++r) {
+      for (int c = 0; c < n; ++c)
+        A(i, r, c) = runif(rng);
+      B(i, r, 0) = runif(rng);
+    }
+  std::unique_ptr<bool[]> nonsingular(new bool[count]);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    BatchedMatrices<P> A_copy = A, B_copy = B;
+    state.ResumeTiming();
+    batched_solve(A_copy, B_copy, nonsingular.get());
+    bm::DoNotOptimize(B_copy(0, 0, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+};
+
+// With Predictable inputs a + b never exceeds p, so the CondSub branch is
+// always predicted correctly; the difference to uniformly random inputs is
+// the cost of mispredictions.
+template <PlusMinusAlgo algo, bool Predictable>
+static void Z32749_PlusData(bm::State &state) {
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, Predictable ? P / 2 - 1 : P - 1);
+  ZP a[N], b[N];
+  for (int i = 0; i < N; ++i) {
+    a[i] = runif(rng);
+    b[i] = runif(rng);
+  }
+
+  for (auto _ : state) {
+    for (int i = 0; i < N; ++i)
+      bm::DoNotOptimize(a[i].operator+<algo>(b[i]));
+  }
+};
+
+template <typename Policy> static void Z32749_Inverse(bm::State &state) {
+  using ZPP = ZpScalar<P, Word, Policy>;
+  const int M = 4096;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(1, P - 1);
+  std::vector<ZPP> a(M);
+  for (auto &v : a)
+    v = runif(rng);
+
+  for (auto _ : state) {
+    for (int i = 0; i < M; ++i)
+      bm::DoNotOptimize(a[i].inverse());
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+static void Z32749_Pow(bm::State &state) {
+  const int M = 4096;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> a(M);
+  for (auto &v : a)
+    v = runif(rng);
+  volatile uint64_t e = 1000003;
+
+  for (auto _ : state) {
+    for (int i = 0; i < M; ++i)
+      bm::DoNotOptimize(a[i].pow(e));
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+// Right-to-left square-and-multiply, for comparison with the sliding window
+static ZP binary_pow(ZP x, uint64_t e) {
+  ZP res(1);
+  for (; e; e >>= 1) {
+    if (e & 1)
+      res *= x;
+    x *= x;
+  }
+  return res;
+}
+
+static void Z32749_PowBinary(bm::State &state) {
+  const int M = 4096;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> a(M);
+  for (auto &v : a)
+    v = runif(rng);
+  volatile uint64_t e = 1000003;
+
+  for (auto _ : state) {
+    for (int i = 0; i < M; ++i)
+      bm::DoNotOptimize(binary_pow(a[i], e));
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+static void Z32749_PowConst(bm::State &state) {
+  const int M = 4096;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> a(M);
+  for (auto &v : a)
+    v = runif(rng);
+
+  for (auto _ : state) {
+    for (int i = 0; i < M; ++i)
+      bm::DoNotOptimize(a[i].pow<1000003>());
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+static void Z32749_PowVec(bm::State &state) {
+  const int M = 4096;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> a(M), c(M);
+  for (auto &v : a)
+    v = runif(rng);
+
+  for (auto _ : state) {
+    VecPowOp<uint16_t, 16, P>::run(a.data(), 1000003, c.data(), M);
+    bm::DoNotOptimize(c.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+// Degree 31 polynomial at 64k points
+static void Z32749_Horner(bm::State &state) {
+  const int M = 65536, D = 32;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> x(M), c(M), coeffs(D);
+  for (auto &v : x)
+    v = runif(rng);
+  for (auto &v : coeffs)
+    v = runif(rng);
+
+  for (auto _ : state) {
+    for (int i = 0; i < M; ++i) {
+      ZP acc = coeffs[D - 1];
+      for (int k = D - 1; k-- > 0;)
+        acc = acc * x[i] + coeffs[k];
+      c[i] = acc;
+    }
+    bm::DoNotOptimize(c.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+static void Z32749_HornerVec(bm::State &state) {
+  const int M = 65536, D = 32;
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> x(M), c(M), coeffs(D);
+  for (auto &v : x)
+    v = runif(rng);
+  for (auto &v : coeffs)
+    v = runif(rng);
+
+  for (auto _ : state) {
+    VecHornerOp<uint16_t, 16, P>::run(coeffs.data(), D, x.data(), c.data(), M);
+    bm::DoNotOptimize(c.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * M);
+};
+
+static void Z32749_RandomMt19937(bm::State &state) {
+  std::mt19937 rng;
+  std::uniform_int_distribution<Word> runif(0, P - 1);
+  std::vector<ZP> a(N);
+
+  for (auto _ : state) {
+    for (auto &v : a)
+      v = runif(rng);
+    bm::DoNotOptimize(a.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+};
+
+static void Z32749_RandomPhilox(bm::State &state) {
+  RandomZp<P> random(0);
+  std::vector<ZP> a(N);
+
+  for (auto _ : state) {
+    random.fill(a.data(), N);
+    bm::DoNotOptimize(a.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+};
+
+template <typename Int> static void Z32749_FitScalar(bm::State &state) {
+  std::mt19937_64 rng;
+  std::vector<Int> in(N);
+  for (auto &v : in)
+    v = Int(rng());
+  std::vector<ZP> out(N);
+
+  for (auto _ : state) {
+    for (int i = 0; i < N; ++i) {
+      const int64_t r = int64_t(in[i]) % P;
+      out[i] = Word(r < 0 ? r + P : r);
+    }
+    bm::DoNotOptimize(out.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+};
+
+template <typename Int> static void Z32749_Fit(bm::State &state) {
+  std::mt19937_64 rng;
+  std::vector<Int> in(N);
+  for (auto &v : in)
+    v = Int(rng());
+  std::vector<ZP> out(N);
+
+  for (auto _ : state) {
+    fit(in.data(), out.data(), N);
+    bm::DoNotOptimize(out.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+};
+
+static void Z32749_ToSymmetric(bm::State &state) {
+  RandomZp<P> random(0);
+  std::vector<ZP> in(N);
+  random.fill(in.data(), N);
+  std::vector<int32_t> out(N);
+
+  for (auto _ : state) {
+    to_symmetric(in.data(), out.data(), N);
+    bm::DoNotOptimize(out.data());
+    bm::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * N);
+};
+
+// Streams state.range(1) rows of width state.range(0) into an echelon basis,
+// either one by one or in batches of 4096 rows
+template <bool Batched> static void Z32749_EchelonStream(bm::State &state) {
+  const int cols = state.range(0);
+  const size_t total = state.range(1);
+  const size_t batch = 4096;
+  RandomZp<P> random(0);
+  std::vector<ZP> rows(batch * cols);
+
+  for (auto _ : state) {
+    EchelonBasis<P> basis(cols);
+    for (size_t first = 0; first < total; first += batch) {
+      state.PauseTiming();
+      random.fill(rows.data(), rows.size());
+      state.ResumeTiming();
+      if constexpr (Batched) {
+        basis.insert(rows.data(), batch);
+      } else {
+        for (size_t r = 0; r < batch; ++r)
+          basis.insert(rows.data() + r * cols);
+      }
+    }
+    bm::DoNotOptimize(basis.rank());
+  }
+  state.SetItemsProcessed(state.iterations() * total);
+};
+
+// Nullspace of a random n x (n + n / 4) matrix, either from a PLUQ
+// factorization computed in place or from a reduced row echelon form
+template <bool Pluq> static void Z32749_Nullspace(bm::State &state) {
+  const int rows = state.range(0);
+  const int cols = rows + rows / 4;
+  RandomZp<P> random(0);
+  std::vector<ZP> a(rows * cols), copy;
+  random.fill(a.data(), a.size());
+
+  for (auto _ : state) {
+    std::vector<ZP> kernel;
+    if constexpr (Pluq) {
+      copy = a;
+      PLUQ<P> f(copy.data(), rows, cols);
+      kernel = f.nullspace();
+    } else {
+      EchelonBasis<P> basis(cols);
+      basis.insert(a.data(), rows);
+      std::vector<bool> is_pivot(cols);
+      for (int i = 0; i < basis.rank(); ++i)
+        is_pivot[basis.pivot(i)] = true;
+      for (int c = 0; c < cols; ++c) {
+        if (is_pivot[c])
+          continue;
+        kernel.resize(kernel.size() + cols, ZP(0));
+        ZP *x = kernel.data() + kernel.size() - cols;
+        x[c] = 1;
+        for (int i = 0; i < basis.rank(); ++i)
+          x[basis.pivot(i)] = -basis.row(i)[c];
+      }
+    }
+    bm::DoNotOptimize(kernel.data());
+  }
+}
+
 BENCHMARK_TEMPLATE(Z32749_Plus, PlusMinusAlgo::Explicit);
 BENCHMARK_TEMPLATE(Z32749_Plus, PlusMinusAlgo::CondSub);
+BENCHMARK_TEMPLATE(Z32749_Plus, PlusMinusAlgo::Branchless);
 BENCHMARK(Z32749_PlusVec);
 
+BENCHMARK_TEMPLATE(Z32749_PlusData, PlusMinusAlgo::CondSub, true);
+BENCHMARK_TEMPLATE(Z32749_PlusData, PlusMinusAlgo::CondSub, false);
+BENCHMARK_TEMPLATE(Z32749_PlusData, PlusMinusAlgo::Branchless, true);
+BENCHMARK_TEMPLATE(Z32749_PlusData, PlusMinusAlgo::Branchless, false);
+
 BENCHMARK_TEMPLATE(Z32749_Minus, PlusMinusAlgo::Explicit);
 BENCHMARK_TEMPLATE(Z32749_Minus, PlusMinusAlgo::CondSub);
+BENCHMARK_TEMPLATE(Z32749_Minus, PlusMinusAlgo::Branchless);
 BENCHMARK(Z32749_MinusVec);
 
 BENCHMARK_TEMPLATE(Z32749_Mul, MulAlgo::Explicit);
 BENCHMARK_TEMPLATE(Z32749_Mul, MulAlgo::MulShift);
 BENCHMARK_TEMPLATE(Z32749_Mul, MulAlgo::MulShiftDirect);
 BENCHMARK_TEMPLATE(Z32749_Mul, MulAlgo::MulShiftDirect2);
+BENCHMARK(Z32749_MulVec);
+
+BENCHMARK_TEMPLATE(Z32749_Inverse, DefaultPolicy);
+BENCHMARK_TEMPLATE(Z32749_Inverse, ConstantTimePolicy);
+
+BENCHMARK(Z32749_Pow);
+BENCHMARK(Z32749_PowBinary);
+BENCHMARK(Z32749_PowConst);
+BENCHMARK(Z32749_PowVec);
+BENCHMARK(Z32749_Horner);
+BENCHMARK(Z32749_HornerVec);
+
+BENCHMARK(Z32749_RandomMt19937);
+BENCHMARK(Z32749_RandomPhilox);
+
+BENCHMARK_TEMPLATE(Z32749_FitScalar, int32_t);
+BENCHMARK_TEMPLATE(Z32749_Fit, int32_t);
+BENCHMARK_TEMPLATE(Z32749_FitScalar, int64_t);
+BENCHMARK_TEMPLATE(Z32749_Fit, int64_t);
+BENCHMARK_TEMPLATE(Z32749_Fit, uint8_t);
+BENCHMARK(Z32749_ToSymmetric);
+
+BENCHMARK_TEMPLATE(Z32749_EchelonStream, false)
+    ->Args({64, 1 << 20})
+    ->Args({512, 1 << 14})
+    ->Unit(bm::kMillisecond);
+BENCHMARK_TEMPLATE(Z32749_EchelonStream, true)
+    ->Args({64, 1 << 20})
+    ->Args({512, 1 << 14})
+    ->Unit(bm::kMillisecond);
+
+BENCHMARK_TEMPLATE(Z32749_Nullspace, false)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK_TEMPLATE(Z32749_Nullspace, true)->Arg(64)->Arg(256)->Arg(1024);
+
+BENCHMARK(Z32749_BatchedSolve)->Arg(8)->Arg(16)->Arg(32)->Arg(64);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,297 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_BATCHED_HPP
+#define ZP_BATCHED_HPP
+
+// Elimination on large batches of small independent matrices.
+//
+// Matrices are stored interleaved: 16 matrices form a group, and the same
+// entry of all matrices of a group occupies a single AVX2 register (lane i is
+// the i-th matrix of the group). All matrices of a group are eliminated
+// simultaneously, pivoting is done per lane with masks.
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <immintrin.h>
+
+#include "zp_eliminator/stats.hpp"
+#include "zp_eliminator/vector_kernels.hpp"
+#include "zp_eliminator/zp_scalar.hpp"
+
+namespace zp {
+
+template <uint64_t prime> class BatchedMatrices {
+public:
+  using Zp = ZpScalar<prime>;
+  using Word = typename Zp::Word;
+  static constexpr int Lanes = 16;
+  static_assert(sizeof(Word) == 2, "Only 16-bit words are vectorized");
+
+  BatchedMatrices(size_t count, int rows, int cols)
+      : count(count), n(rows), m(cols),
+        data((count + Lanes - 1) / Lanes * rows * cols * Lanes, Zp(0)) {}
+
+  size_t size() const { return count; }
+  size_t groups() const { return (count + Lanes - 1) / Lanes; }
+  int rows() const { return n; }
+  int cols() const { return m; }
+
+  Zp &operator()(size_t matrix, int row, int col) {
+    return entry(matrix / Lanes, row, col)[matrix % Lanes];
+  }
+  const Zp &operator()(size_t matrix, int row, int col) const {
+    return entry(matrix / Lanes, row, col)[matrix % Lanes];
+  }
+
+  // Pointer to Lanes consecutive values of (row, col) entry of a group
+  Zp *entry(size_t group, int row, int col) {
+    return data.data() + ((group * n + row) * m + col) * Lanes;
+  }
+  const Zp *entry(size_t group, int row, int col) const {
+    return data.data() + ((group * n + row) * m + col) * Lanes;
+  }
+
+private:
+  size_t count;
+  int n, m;
+  std::vector<Zp> data;
+};
+
+namespace batched {
+template <uint16_t P> struct Ops {
+  using Add = VecAddOp<uint16_t, 16, P>;
+  using Sub = VecSubOp<uint16_t, 16, P>;
+  using Mul = VecMulOp<uint16_t, 16, P>;
+
+  __m256i p = _mm256_set1_epi16(P);
+  __m256i z = _mm256_setzero_si256();
+  __m256i j = Mul::j();
+  __m256i p32 = Mul::p();
+
+  __m256i mul(const __m256i &a, const __m256i &b) const {
+    return Mul::run(a, b, j, p32);
+  }
+  __m256i sub(const __m256i &a, const __m256i &b) const {
+    return Sub::run(a, b, p, z);
+  }
+  // a - f * b
+  __m256i mul_sub(const __m256i &a, const __m256i &f,
+                  const __m256i &b) const {
+    return sub(a, mul(f, b));
+  }
+  __m256i nonzero(const __m256i &a) const {
+    return _mm256_xor_si256(_mm256_cmpeq_epi16(a, z), _mm256_set1_epi16(-1));
+  }
+  // Per-lane Fermat inverse, zero is mapped to zero
+  __m256i inverse(const __m256i &a) const {
+    static constexpr PowSchedule schedule = make_pow_schedule(P - 2);
+    return VecPowOp<uint16_t, 16, P>::run(a, schedule, j, p32);
+  }
+};
+
+template <typename Zp> inline __m256i load(const Zp *ptr) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+}
+
+template <typename Zp> inline void store(Zp *ptr, const __m256i &v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(ptr), v);
+}
+
+inline bool any(const __m256i &mask) { return !_mm256_testz_si256(mask, mask); }
+
+// Gauss-Jordan elimination of [A | B] for a group of n x n matrices A and
+// n x k matrices B. Returns mask of lanes with singular A; for the others B
+// is replaced with A^-1 B.
+template <uint64_t prime>
+__m256i gauss_jordan(BatchedMatrices<prime> &A, BatchedMatrices<prime> &B,
+                     size_t group) {
+  constexpr int Lanes = BatchedMatrices<prime>::Lanes;
+  const Ops<prime> ops;
+  const int n = A.rows(), k = B.cols();
+  __m256i singular = _mm256_setzero_si256();
+
+  for (int c = 0; c < n; ++c) {
+    {
+      PhaseTimer timer(Phase::PivotSearch);
+      __m256i found = _mm256_setzero_si256();
+      for (int r = c; r < n; ++r) {
+        const __m256i nz = ops.nonzero(load(A.entry(group, r, c)));
+        const __m256i sel = _mm256_andnot_si256(found, nz);
+        found = _mm256_or_si256(found, nz);
+        if (r == c || !any(sel))
+          continue;
+        PhaseTimer swap_timer(Phase::RowSwap);
+        auto swap = [&](auto *row_c, auto *row_r) {
+          const __m256i vc = load(row_c), vr = load(row_r);
+          store(row_c, _mm256_blendv_epi8(vc, vr, sel));
+          store(row_r, _mm256_blendv_epi8(vr, vc, sel));
+        };
+        for (int j = c; j < n; ++j)
+          swap(A.entry(group, c, j), A.entry(group, r, j));
+        for (int j = 0; j < k; ++j)
+          swap(B.entry(group, c, j), B.entry(group, r, j));
+      }
+      singular = _mm256_or_si256(singular, _mm256_andnot_si256(
+                                               found, _mm256_set1_epi16(-1)));
+    }
+
+    __m256i inv;
+    {
+      PhaseTimer timer(Phase::Inversion);
+      count(Counter::Inversion, Lanes);
+      inv = ops.inverse(load(A.entry(group, c, c)));
+    }
+
+    PhaseTimer timer(Phase::RowUpdate);
+    store(A.entry(group, c, c), _mm256_set1_epi16(1));
+    for (int j = c + 1; j < n; ++j)
+      store(A.entry(group, c, j), ops.mul(load(A.entry(group, c, j)), inv));
+    for (int j = 0; j < k; ++j)
+      store(B.entry(group, c, j), ops.mul(load(B.entry(group, c, j)), inv));
+    count(Counter::Mul, Lanes * (n - c - 1 + k));
+
+    for (int r = 0; r < n; ++r) {
+      if (r == c)
+        continue;
+      const __m256i f = load(A.entry(group, r, c));
+      if (!any(f))
+        continue;
+      store(A.entry(group, r, c), _mm256_setzero_si256());
+      for (int j = c + 1; j < n; ++j)
+        store(A.entry(group, r, j), ops.mul_sub(load(A.entry(group, r, j)), f,
+                                                load(A.entry(group, c, j))));
+      for (int j = 0; j < k; ++j)
+        store(B.entry(group, r, j), ops.mul_sub(load(B.entry(group, r, j)), f,
+                                                load(B.entry(group, c, j))));
+      count(Counter::Mul, Lanes * (n - c - 1 + k));
+      count(Counter::Sub, Lanes * (n - c - 1 + k));
+    }
+  }
+  return singular;
+}
+
+} // namespace batched
+
+// Computes ranks of all matrices, destroying A
+template <uint64_t prime>
+void batched_rank(BatchedMatrices<prime> &A, int *ranks) {
+  using namespace batched;
+  constexpr int Lanes = BatchedMatrices<prime>::Lanes;
+  const Ops<prime> ops;
+  const int n = A.rows(), m = A.cols();
+  // Per-row lane masks and the gathered pivot row
+  using Word = typename BatchedMatrices<prime>::Word;
+  std::vector<Word> used(n * Lanes), sel(n * Lanes), pivot_row(m * Lanes);
+
+  for (size_t g = 0; g < A.groups(); ++g) {
+    std::fill(used.begin(), used.end(), Word(0));
+    __m256i rank = _mm256_setzero_si256();
+
+    for (int c = 0; c < m; ++c) {
+      __m256i found = _mm256_setzero_si256();
+      {
+        // Each lane picks the first row that is not a pivot row yet
+        PhaseTimer timer(Phase::PivotSearch);
+        for (int r = 0; r < n; ++r) {
+          const __m256i nz = ops.nonzero(load(A.entry(g, r, c)));
+          const __m256i s = _mm256_andnot_si256(
+              _mm256_or_si256(found, load(&used[r * Lanes])), nz);
+          store(&sel[r * Lanes], s);
+          found = _mm256_or_si256(found, s);
+        }
+        if (!any(found))
+          continue;
+        rank = _mm256_sub_epi16(rank, found);
+        for (int j = c; j < m; ++j) {
+          __m256i v = _mm256_setzero_si256();
+          for (int r = 0; r < n; ++r)
+            v = _mm256_or_si256(v, _mm256_and_si256(load(&sel[r * Lanes]),
+                                                    load(A.entry(g, r, j))));
+          store(&pivot_row[j * Lanes], v);
+        }
+      }
+
+      __m256i inv;
+      {
+        PhaseTimer timer(Phase::Inversion);
+        count(Counter::Inversion, Lanes);
+        inv = ops.inverse(load(&pivot_row[c * Lanes]));
+      }
+
+      PhaseTimer timer(Phase::RowUpdate);
+      for (int r = 0; r < n; ++r) {
+        const __m256i pivot =
+            _mm256_or_si256(load(&used[r * Lanes]), load(&sel[r * Lanes]));
+        store(&used[r * Lanes], pivot);
+        const __m256i f = _mm256_andnot_si256(
+            pivot, ops.mul(load(A.entry(g, r, c)), inv));
+        if (!any(f))
+          continue;
+        for (int j = c + 1; j < m; ++j)
+          store(A.entry(g, r, j),
+                ops.mul_sub(load(A.entry(g, r, j)), f,
+                            load(&pivot_row[j * Lanes])));
+        count(Counter::Mul, Lanes * (m - c));
+        count(Counter::Sub, Lanes * (m - c - 1));
+      }
+    }
+
+    uint16_t lanes[Lanes];
+    store(lanes, rank);
+    for (size_t i = 0; i < Lanes && g * Lanes + i < A.size(); ++i)
+      ranks[g * Lanes + i] = lanes[i];
+  }
+}
+
+// Solves A X = B for square A, destroying A; B is replaced with the solution.
+// nonsingular[i] is set to false if i-th A is singular, corresponding X is
+// undefined.
+template <uint64_t prime>
+void batched_solve(BatchedMatrices<prime> &A, BatchedMatrices<prime> &B,
+                   bool *nonsingular) {
+  using namespace batched;
+  constexpr int Lanes = BatchedMatrices<prime>::Lanes;
+  for (size_t g = 0; g < A.groups(); ++g) {
+    const __m256i singular = gauss_jordan(A, B, g);
+    uint16_t lanes[Lanes];
+    store(lanes, singular);
+    for (size_t i = 0; i < Lanes && g * Lanes + i < A.size(); ++i)
+      nonsingular[g * Lanes + i] = !lanes[i];
+  }
+}
+
+// Replaces square matrices with their inverses, see batched_solve
+template <uint64_t prime>
+void batched_inverse(BatchedMatrices<prime> &A, bool *nonsingular) {
+  BatchedMatrices<prime> inv(A.size(), A.rows(), A.rows());
+  for (size_t i = 0; i < A.size(); ++i)
+    for (int j = 0; j < A.rows(); ++j)
+      inv(i, j, j) = 1;
+  batched_solve(A, inv, nonsingular);
+  A = std::move(inv);
+}
+} // namespace zp
+
+#endif
@@ -0,0 +1,189 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_CONVERT_HPP
+#define ZP_CONVERT_HPP
+
+// Bulk conversion between machine integers and Zp.
+//
+// fit() reduces arrays of signed or unsigned 8/16/32/64-bit integers into Zp.
+// Negative values are reduced as their two's complement bit pattern
+// u = v + 2^bits with 2^bits mod p subtracted afterwards. The AVX2 path for
+// 16-bit words uses the multiply-shift DivMod constants on 32-bit lanes,
+// 64-bit values are split into halves as hi * 2^32 + lo.
+//
+// to_symmetric() maps Zp elements to the symmetric range (-p/2, p/2] used by
+// rational reconstruction.
+
+#include <cstdint>
+#include <type_traits>
+
+#include <immintrin.h>
+
+#include "zp_eliminator/stats.hpp"
+#include "zp_eliminator/vector_kernels.hpp"
+#include "zp_eliminator/zp_scalar.hpp"
+
+namespace zp {
+namespace convert {
+template <typename Word, Word P> constexpr Word pow2_mod(int bits) {
+  uint64_t res = 1;
+  for (int i = 0; i < bits; ++i)
+    res = res * 2 % P;
+  return res;
+}
+
+template <typename Word, Word P, typename Int> Word reduce(const Int &v) {
+  using UInt = std::make_unsigned_t<Int>;
+  const Word r = UInt(v) % P;
+  if constexpr (std::is_signed_v<Int>) {
+    constexpr Word C = pow2_mod<Word, P>(8 * sizeof(Int));
+    const Word mask = Word(0) - Word(v < 0);
+    return SubOp<Word, P, PlusMinusAlgo::Branchless>()(r, Word(C & mask));
+  } else {
+    return r;
+  }
+}
+
+// Eight values of Int loaded as unsigned 32-bit lanes (64-bit inputs are
+// split into halves), sign mask is set for negative values
+template <typename Int> struct VecLoad {
+  static constexpr bool Signed = std::is_signed_v<Int>;
+
+  inline static void run(const Int *in, __m256i &lo, __m256i &hi,
+                         __m256i &sign) {
+    const __m256i z = _mm256_setzero_si256();
+    hi = z;
+    if constexpr (sizeof(Int) == 1) {
+      lo = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(in)));
+      sign = Signed ? _mm256_cmpgt_epi32(lo, _mm256_set1_epi32(INT8_MAX)) : z;
+    } else if constexpr (sizeof(Int) == 2) {
+      lo = _mm256_cvtepu16_epi32(
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(in)));
+      sign = Signed ? _mm256_cmpgt_epi32(lo, _mm256_set1_epi32(INT16_MAX)) : z;
+    } else if constexpr (sizeof(Int) == 4) {
+      lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+      sign = Signed ? _mm256_cmpgt_epi32(z, lo) : z;
+    } else {
+      // [lo0 lo1 lo2 lo3 hi0 hi1 hi2 hi3] for each half
+      const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+      const __m256i a = _mm256_permutevar8x32_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in)), idx);
+      const __m256i b = _mm256_permutevar8x32_epi32(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 4)), idx);
+      lo = _mm256_permute2x128_si256(a, b, 0x20);
+      hi = _mm256_permute2x128_si256(a, b, 0x31);
+      sign = Signed ? _mm256_cmpgt_epi32(z, hi) : z;
+    }
+  }
+};
+
+template <uint16_t P, typename Int> struct VecFit {
+  using Load = VecLoad<Int>;
+  using DivModT = VecDivMod<P, ~uint32_t(0)>;
+  static constexpr uint16_t R = pow2_mod<uint16_t, P>(32);
+  static constexpr uint16_t C = pow2_mod<uint16_t, P>(8 * sizeof(Int));
+
+  // Eight values reduced into 32-bit lanes
+  inline static __m256i run(const Int *in, const __m256i &j,
+                            const __m256i &p) {
+    __m256i lo, hi, sign;
+    Load::run(in, lo, hi, sign);
+    __m256i r = DivModT::reduce(lo, j, p);
+    if constexpr (sizeof(Int) == 8) {
+      // hi * R + lo < p^2 + p
+      const __m256i h = _mm256_mullo_epi32(DivModT::reduce(hi, j, p),
+                                           _mm256_set1_epi32(R));
+      r = DivModT::reduce(_mm256_add_epi32(h, r), j, p);
+    }
+    if constexpr (Load::Signed) {
+      r = _mm256_sub_epi32(r, _mm256_and_si256(sign, _mm256_set1_epi32(C)));
+      r = _mm256_add_epi32(
+          r, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), r),
+                              p));
+    }
+    return r;
+  }
+};
+} // namespace convert
+
+template <typename Int, uint64_t prime, typename T, typename Policy>
+void fit(const Int *in, ZpScalar<prime, T, Policy> *out, size_t n) {
+  using Zp = ZpScalar<prime, T, Policy>;
+  using Word = typename Zp::Word;
+  static_assert(std::is_integral_v<Int>);
+  static_assert(sizeof(Zp) == sizeof(Word));
+  count(Counter::Reduction, n);
+
+  size_t i = 0;
+  if constexpr (sizeof(Word) == 2) {
+    using Fit = convert::VecFit<Word(prime), Int>;
+    const __m256i j = Fit::DivModT::j();
+    const __m256i p = Fit::DivModT::p();
+    for (; i + 16 <= n; i += 16) {
+      const __m256i r0 = Fit::run(in + i, j, p);
+      const __m256i r1 = Fit::run(in + i + 8, j, p);
+      const __m256i r =
+          _mm256_permute4x64_epi64(_mm256_packus_epi32(r0, r1), 0xD8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), r);
+    }
+  }
+  for (; i < n; ++i)
+    out[i] = convert::reduce<Word, Word(prime)>(in[i]);
+}
+
+template <typename Int, uint64_t prime, typename T, typename Policy>
+void to_symmetric(const ZpScalar<prime, T, Policy> *in, Int *out, size_t n) {
+  using Zp = ZpScalar<prime, T, Policy>;
+  using Word = typename Zp::Word;
+  static_assert(std::is_signed_v<Int> && sizeof(Int) >= sizeof(Word),
+                "Signed type at least as wide as Word is required");
+  constexpr Word Half = prime / 2;
+
+  size_t i = 0;
+  if constexpr (sizeof(Word) == 2 && sizeof(Int) <= 4) {
+    const __m256i half = _mm256_set1_epi16(Half);
+    const __m256i p16 = _mm256_set1_epi16(prime);
+    for (; i + 16 <= n; i += 16) {
+      const __m256i v =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+      const __m256i s =
+          _mm256_sub_epi16(v, _mm256_and_si256(_mm256_cmpgt_epi16(v, half), p16));
+      if constexpr (sizeof(Int) == 2) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), s);
+      } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                            _mm256_cvtepi16_epi32(_mm256_castsi256_si128(s)));
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(out + i + 8),
+            _mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1)));
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    const Word v = in[i].value();
+    out[i] = Int(v) - Int(v > Half ? prime : 0);
+  }
+}
+} // namespace zp
+
+#endif
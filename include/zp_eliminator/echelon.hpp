@@ -0,0 +1,163 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_ECHELON_HPP
+#define ZP_ECHELON_HPP
+
+// Incremental (online) elimination: rows are appended one by one or in
+// batches to a basis kept in reduced row echelon form. Each basis row is
+// normalized to 1 in its pivot column and all other basis rows are zero in
+// that column, so a new row is reduced by subtracting row[pivot] * basis_row
+// for every basis row, in any order.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "zp_eliminator/stats.hpp"
+#include "zp_eliminator/vector_kernels.hpp"
+#include "zp_eliminator/zp_scalar.hpp"
+
+namespace zp {
+template <uint64_t prime, typename T = minimal_type_t<prime>>
+class EchelonBasis {
+public:
+  using Zp = ZpScalar<prime, T>;
+  using Word = typename Zp::Word;
+  // Rows of a batch that are reduced together by each basis row
+  static constexpr size_t BlockRows = 8;
+
+  explicit EchelonBasis(int cols) : n(cols), pivot_row(cols, -1) {}
+
+  int cols() const { return n; }
+  int rank() const { return pivot_col.size(); }
+  const Zp *row(int i) const { return rows.data() + size_t(i) * n; }
+  // Pivot column of i-th basis row
+  int pivot(int i) const { return pivot_col[i]; }
+
+  // Reduces row against the basis, returns true if the result is non-zero
+  bool reduce(Zp *row) const {
+    reduce(row, 0, rank());
+    return std::any_of(row, row + n, [](const Zp &v) { return bool(v); });
+  }
+
+  // Returns true if the row was linearly independent and rank increased
+  bool insert(const Zp *row) {
+    scratch.assign(row, row + n);
+    reduce(scratch.data(), 0, rank());
+    return insert_reduced(scratch.data());
+  }
+
+  // Inserts count rows stored consecutively, returns rank increase. Every
+  // basis row is applied to a block of rows at once, so it is read from
+  // memory once per block instead of once per row.
+  int insert(const Zp *rows_begin, size_t count) {
+    const int initial = rank();
+    for (size_t first = 0; first < count; first += BlockRows) {
+      const size_t block = std::min(BlockRows, count - first);
+      scratch.assign(rows_begin + first * n, rows_begin + (first + block) * n);
+      const int old_rank = rank();
+      {
+        PhaseTimer timer(Phase::RowUpdate);
+        for (int b = 0; b < old_rank; ++b)
+          for (size_t r = 0; r < block; ++r) {
+            Zp *current = scratch.data() + r * n;
+            const Zp f = current[pivot_col[b]];
+            if (f)
+              row_update(row(b), f, current, n);
+          }
+      }
+      for (size_t r = 0; r < block; ++r) {
+        Zp *current = scratch.data() + r * n;
+        reduce(current, old_rank, rank());
+        insert_reduced(current);
+      }
+    }
+    return rank() - initial;
+  }
+
+  // Treats the last column as the right-hand side of the equations a x = b
+  // stored as rows [a | b]. Writes a solution with free variables set to zero
+  // into x (cols() - 1 values); returns false if the system is inconsistent.
+  bool solve(Zp *x) const {
+    if (pivot_row[n - 1] >= 0)
+      return false;
+    PhaseTimer timer(Phase::BackSubstitution);
+    std::fill(x, x + n - 1, Zp(0));
+    for (int i = 0; i < rank(); ++i)
+      x[pivot_col[i]] = row(i)[n - 1];
+    return true;
+  }
+
+private:
+  Zp *mutable_row(int i) { return rows.data() + size_t(i) * n; }
+
+  // Reduces row by basis rows [first, last)
+  void reduce(Zp *current, int first, int last) const {
+    PhaseTimer timer(Phase::RowUpdate);
+    for (int b = first; b < last; ++b) {
+      const Zp f = current[pivot_col[b]];
+      if (f)
+        row_update(row(b), f, current, n);
+    }
+  }
+
+  // Appends a row that is already reduced against the basis
+  bool insert_reduced(Zp *current) {
+    int col;
+    {
+      PhaseTimer timer(Phase::PivotSearch);
+      col = std::find_if(current, current + n,
+                         [](const Zp &v) { return bool(v); }) -
+            current;
+    }
+    if (col == n)
+      return false;
+
+    {
+      PhaseTimer timer(Phase::Inversion);
+      row_scale(current[col].inverse(), current, n);
+    }
+
+    {
+      PhaseTimer timer(Phase::RowUpdate);
+      for (int b = 0; b < rank(); ++b) {
+        const Zp f = row(b)[col];
+        if (f)
+          row_update(current, f, mutable_row(b), n);
+      }
+    }
+
+    pivot_row[col] = rank();
+    pivot_col.push_back(col);
+    rows.insert(rows.end(), current, current + n);
+    return true;
+  }
+
+  int n;
+  std::vector<Zp> rows;
+  std::vector<int> pivot_col;
+  std::vector<int> pivot_row;
+  std::vector<Zp> scratch;
+};
+} // namespace zp
+
+#endif
@@ -0,0 +1,242 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_PLUQ_HPP
+#define ZP_PLUQ_HPP
+
+// PLUQ factorization of a dense n x m matrix, computed in place:
+//   A = P * L * U * Q
+// with r = rank(A), L unit lower trapezoidal n x r and U upper trapezoidal
+// r x m with non-zero diagonal. After factorization the matrix holds the
+// permuted rows; the strictly lower part of the first r columns is L and the
+// upper part of the first r rows is U.
+//
+// Rows are processed in their original order and a pivot is the leftmost (in
+// original column order) non-zero of the reduced row, so the pivot rows are the
+// row rank profile and the pivot columns are the column rank profile of A.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "zp_eliminator/stats.hpp"
+#include "zp_eliminator/vector_kernels.hpp"
+#include "zp_eliminator/zp_scalar.hpp"
+
+namespace zp {
+template <uint64_t prime, typename T = minimal_type_t<prime>> class PLUQ {
+public:
+  using Zp = ZpScalar<prime, T>;
+
+  // Factorizes rows x cols row-major matrix a in place; a must outlive this
+  // object
+  PLUQ(Zp *a, int rows, int cols)
+      : a(a), n(rows), m(cols), row_perm(rows), col_perm(cols) {
+    for (int i = 0; i < n; ++i)
+      row_perm[i] = i;
+    for (int i = 0; i < m; ++i)
+      col_perm[i] = i;
+    factorize();
+  }
+
+  int rows() const { return n; }
+  int cols() const { return m; }
+  int rank() const { return r; }
+  // i-th row of the factorized matrix
+  const Zp *row(int i) const { return a + size_t(i) * m; }
+  // Entries of the factors, L is n x r and U is r x m
+  Zp L(int i, int j) const {
+    return i == j ? Zp(1) : i > j ? row(i)[j] : Zp(0);
+  }
+  Zp U(int i, int j) const { return i <= j ? row(i)[j] : Zp(0); }
+  // Original row of i-th factorized row
+  const std::vector<int> &row_permutation() const { return row_perm; }
+  // Original column of i-th factorized column
+  const std::vector<int> &col_permutation() const { return col_perm; }
+
+  // Lexicographically smallest set of independent rows, increasing
+  std::vector<int> row_rank_profile() const {
+    return std::vector<int>(row_perm.begin(), row_perm.begin() + r);
+  }
+
+  // Lexicographically smallest set of independent columns, increasing
+  std::vector<int> column_rank_profile() const {
+    std::vector<int> profile(col_perm.begin(), col_perm.begin() + r);
+    std::sort(profile.begin(), profile.end());
+    return profile;
+  }
+
+  // Zero for singular (or non-square) matrices
+  Zp determinant() const {
+    if (n != m || r < n)
+      return 0;
+    Zp det = odd_permutation ? -Zp(1) : Zp(1);
+    for (int i = 0; i < r; ++i)
+      det *= row(i)[i];
+    return det;
+  }
+
+  // Basis of {x : A x = 0}: cols() - rank() vectors of cols() elements,
+  // stored row by row
+  std::vector<Zp> nullspace() const {
+    const int k = m - r;
+    // W = U1^-1 U2, where U = [U1 U2] and U1 is r x r upper triangular
+    std::vector<Zp> w(size_t(r) * k);
+    {
+      PhaseTimer timer(Phase::BackSubstitution);
+      for (int i = r - 1; i >= 0; --i) {
+        Zp *wi = w.data() + size_t(i) * k;
+        std::copy(row(i) + r, row(i) + m, wi);
+        for (int j = i + 1; j < r; ++j)
+          if (row(i)[j])
+            row_update(w.data() + size_t(j) * k, row(i)[j], wi, k);
+        row_scale(row(i)[i].inverse(), wi, k);
+      }
+    }
+    // Q x = [-W; I]
+    std::vector<Zp> basis(size_t(k) * m, Zp(0));
+    for (int v = 0; v < k; ++v) {
+      Zp *x = basis.data() + size_t(v) * m;
+      for (int i = 0; i < r; ++i)
+        x[col_perm[i]] = -w[size_t(i) * k + v];
+      x[col_perm[r + v]] = 1;
+    }
+    return basis;
+  }
+
+  // Basis of {y : y^T A = 0}: rows() - rank() vectors of rows() elements,
+  // stored row by row. Each vector expresses a dependent row of A through
+  // the rows of the row rank profile.
+  std::vector<Zp> left_nullspace() const {
+    const int k = n - r;
+    std::vector<Zp> basis(size_t(k) * n, Zp(0));
+    // V = L2 L1^-1, where L = [L1; L2] and L1 is r x r unit lower triangular
+    std::vector<Zp> v(r);
+    PhaseTimer timer(Phase::BackSubstitution);
+    for (int d = 0; d < k; ++d) {
+      std::copy(row(r + d), row(r + d) + r, v.begin());
+      for (int i = r - 1; i > 0; --i)
+        if (v[i])
+          row_update(row(i), v[i], v.data(), i);
+      // P^T y = [-V, I]
+      Zp *y = basis.data() + size_t(d) * n;
+      for (int i = 0; i < r; ++i)
+        y[row_perm[i]] = -v[i];
+      y[row_perm[r + d]] = 1;
+    }
+    return basis;
+  }
+
+  // Solves A x = b (rows() right-hand side values, cols() unknowns), free
+  // variables are set to zero; returns false if the system is inconsistent
+  bool solve(const Zp *b, Zp *x) const {
+    PhaseTimer timer(Phase::BackSubstitution);
+    // L y = P^T b
+    std::vector<Zp> y(r);
+    for (int i = 0; i < r; ++i) {
+      Zp sum = b[row_perm[i]];
+      for (int j = 0; j < i; ++j)
+        sum -= row(i)[j] * y[j];
+      y[i] = sum;
+    }
+    for (int i = r; i < n; ++i) {
+      Zp sum = b[row_perm[i]];
+      for (int j = 0; j < r; ++j)
+        sum -= row(i)[j] * y[j];
+      if (sum)
+        return false;
+    }
+    // U1 (Q x)[0, r) = y, (Q x)[r, m) = 0
+    std::fill(x, x + m, Zp(0));
+    for (int i = r - 1; i >= 0; --i) {
+      Zp sum = y[i];
+      for (int j = i + 1; j < r; ++j)
+        sum -= row(i)[j] * x[col_perm[j]];
+      x[col_perm[i]] = sum * row(i)[i].inverse();
+    }
+    return true;
+  }
+
+private:
+  Zp *mutable_row(int i) { return a + size_t(i) * m; }
+
+  void factorize() {
+    for (int i = 0; i < n && r < m; ++i) {
+      // Row i is already reduced by the previous pivots
+      Zp *current = mutable_row(i);
+      int pivot = -1;
+      {
+        PhaseTimer timer(Phase::PivotSearch);
+        for (int j = r; j < m; ++j)
+          if (current[j] && (pivot < 0 || col_perm[j] < col_perm[pivot]))
+            pivot = j;
+      }
+      if (pivot < 0)
+        continue;
+
+      {
+        PhaseTimer timer(Phase::RowSwap);
+        if (pivot != r) {
+          for (int k = 0; k < n; ++k)
+            std::swap(mutable_row(k)[r], mutable_row(k)[pivot]);
+          std::swap(col_perm[r], col_perm[pivot]);
+          odd_permutation ^= 1;
+        }
+        // Rotation keeps dependent rows in their original order
+        if (i != r) {
+          std::rotate(mutable_row(r), current, current + m);
+          std::rotate(row_perm.begin() + r, row_perm.begin() + i,
+                      row_perm.begin() + i + 1);
+          odd_permutation ^= (i - r) & 1;
+        }
+      }
+
+      const Zp *u = row(r);
+      Zp inverse;
+      {
+        PhaseTimer timer(Phase::Inversion);
+        inverse = u[r].inverse();
+      }
+      {
+        PhaseTimer timer(Phase::RowUpdate);
+        for (int k = i + 1; k < n; ++k) {
+          Zp *lower = mutable_row(k);
+          if (!lower[r])
+            continue;
+          const Zp l = lower[r] * inverse;
+          row_update(u + r + 1, l, lower + r + 1, m - r - 1);
+          lower[r] = l;
+        }
+      }
+      ++r;
+    }
+  }
+
+  Zp *a;
+  int n, m;
+  int r = 0;
+  bool odd_permutation = false;
+  std::vector<int> row_perm;
+  std::vector<int> col_perm;
+};
+} // namespace zp
+
+#endif
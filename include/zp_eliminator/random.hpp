@@ -0,0 +1,194 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_RANDOM_HPP
+#define ZP_RANDOM_HPP
+
+// Uniform random Zp elements from the Philox4x32-10 counter-based generator
+// (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+//
+// Element i of a stream is a function of (stream, i) only, so generators are
+// seekable and threads using different streams (or disjoint ranges of the same
+// stream) produce independent values. Reduction into Zp uses Lemire's
+// multiply-shift with rejection; a rejected element is regenerated from the
+// next counter domain at the same position.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include <immintrin.h>
+
+#include "zp_eliminator/zp_scalar.hpp"
+
+namespace zp {
+class Philox4x32 {
+public:
+  using Block = std::array<uint32_t, 4>;
+  static constexpr int Rounds = 10;
+  static constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+  static constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+  explicit Philox4x32(uint64_t key) : k0(key), k1(key >> 32) {}
+
+  Block operator()(Block ctr) const {
+    uint32_t key0 = k0, key1 = k1;
+    for (int round = 0; round < Rounds; ++round) {
+      const uint64_t p0 = uint64_t(M0) * ctr[0];
+      const uint64_t p1 = uint64_t(M1) * ctr[2];
+      ctr = {uint32_t(p1 >> 32) ^ ctr[1] ^ key0, uint32_t(p1),
+             uint32_t(p0 >> 32) ^ ctr[3] ^ key1, uint32_t(p0)};
+      key0 += W0;
+      key1 += W1;
+    }
+    return ctr;
+  }
+
+  // Eight blocks at once; i-th 32-bit lane of ctr[w] holds w-th word of the
+  // i-th block
+  void operator()(__m256i ctr[4]) const {
+    const __m256i m0 = _mm256_set1_epi32(M0), m1 = _mm256_set1_epi32(M1);
+    __m256i key0 = _mm256_set1_epi32(k0), key1 = _mm256_set1_epi32(k1);
+    const __m256i w0 = _mm256_set1_epi32(W0), w1 = _mm256_set1_epi32(W1);
+    for (int round = 0; round < Rounds; ++round) {
+      __m256i hi0, lo0, hi1, lo1;
+      mulhilo(m0, ctr[0], hi0, lo0);
+      mulhilo(m1, ctr[2], hi1, lo1);
+      ctr[0] = _mm256_xor_si256(_mm256_xor_si256(hi1, ctr[1]), key0);
+      ctr[1] = lo1;
+      ctr[2] = _mm256_xor_si256(_mm256_xor_si256(hi0, ctr[3]), key1);
+      ctr[3] = lo0;
+      key0 = _mm256_add_epi32(key0, w0);
+      key1 = _mm256_add_epi32(key1, w1);
+    }
+  }
+
+  // 32 x 32 -> 64 products of 32-bit lanes, split into high and low halves
+  static void mulhilo(const __m256i &a, const __m256i &b, __m256i &hi,
+                      __m256i &lo) {
+    const __m256i even = _mm256_mul_epu32(a, b);
+    const __m256i odd =
+        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+  }
+
+private:
+  uint32_t k0, k1;
+};
+
+template <uint64_t prime, typename T = minimal_type_t<prime>,
+          typename Policy = DefaultPolicy>
+class RandomZp {
+public:
+  using Zp = ZpScalar<prime, T, Policy>;
+  using Word = typename Zp::Word;
+  static_assert(sizeof(Word) <= 4, "Lemire reduction of 32-bit samples");
+  // Elements are produced in chunks of 8 Philox blocks: element i is the
+  // word (i % Chunk) / 8 of the block 8 * (i / Chunk) + i % 8
+  static constexpr int Chunk = 32;
+  // Samples below Threshold are rejected
+  static constexpr uint32_t Threshold = (uint64_t(1) << 32) % prime;
+
+  explicit RandomZp(uint64_t stream, uint64_t position = 0)
+      : philox(stream), position(position) {}
+
+  void seek(uint64_t pos) { position = pos; }
+  uint64_t tell() const { return position; }
+
+  Zp operator()() { return at(position++); }
+
+  // Element at a given position of the stream, independent of current one
+  Zp at(uint64_t pos) const {
+    const uint64_t block = pos / Chunk * 8 + pos % 8;
+    const int word = pos % Chunk / 8;
+    for (uint32_t domain = 0;; ++domain) {
+      const auto random = philox({uint32_t(block), uint32_t(block >> 32),
+                                  domain, 0})[word];
+      const uint64_t m = uint64_t(random) * prime;
+      if (uint32_t(m) >= Threshold)
+        return Word(m >> 32);
+    }
+  }
+
+  void fill(Zp *out, size_t n) {
+    static_assert(sizeof(Zp) == sizeof(Word));
+    const size_t head = std::min<size_t>(n, (Chunk - position % Chunk) % Chunk);
+    const size_t chunks = (n - head) / Chunk;
+    for (size_t i = 0; i < head; ++i)
+      out[i] = (*this)();
+    out += head;
+    for (size_t i = 0; i < chunks; ++i, position += Chunk)
+      fill_chunk(out + i * Chunk);
+    out += chunks * Chunk;
+    for (size_t i = 0; i < n - head - chunks * Chunk; ++i)
+      out[i] = (*this)();
+  }
+
+private:
+  void fill_chunk(Zp *out) const {
+    const uint64_t block = position / Chunk * 8;
+    __m256i ctr[4] = {
+        _mm256_add_epi32(_mm256_set1_epi32(uint32_t(block)),
+                         _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)),
+        _mm256_set1_epi32(uint32_t(block >> 32)), _mm256_setzero_si256(),
+        _mm256_setzero_si256()};
+    philox(ctr);
+
+    const __m256i p = _mm256_set1_epi32(uint32_t(prime));
+    const __m256i threshold = _mm256_set1_epi32(Threshold - 1);
+    __m256i values[4];
+    uint32_t rejected = 0;
+    for (int w = 0; w < 4; ++w) {
+      __m256i lo;
+      Philox4x32::mulhilo(ctr[w], p, values[w], lo);
+      const __m256i reject =
+          _mm256_cmpeq_epi32(_mm256_min_epu32(lo, threshold), lo);
+      rejected |=
+          uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(reject))) << (8 * w);
+    }
+
+    if constexpr (sizeof(Word) == 2) {
+      const __m256i lo = _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(values[0], values[1]), 0xD8);
+      const __m256i hi = _mm256_permute4x64_epi64(
+          _mm256_packus_epi32(values[2], values[3]), 0xD8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), lo);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 16), hi);
+    } else {
+      for (int w = 0; w < 4; ++w)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 8 * w),
+                            values[w]);
+    }
+
+    while (rejected) {
+      const int k = __builtin_ctz(rejected);
+      out[k] = at(position + k);
+      rejected &= rejected - 1;
+    }
+  }
+
+  Philox4x32 philox;
+  uint64_t position;
+};
+} // namespace zp
+
+#endif
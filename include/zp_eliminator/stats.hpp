@@ -0,0 +1,190 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_STATS_HPP
+#define ZP_STATS_HPP
+
+// Opt-in hot-path instrumentation. Operation counters and phase timers are
+// compiled in only with ZP_ELIMINATOR_INSTRUMENTATION defined; otherwise
+// count() and PhaseTimer are empty and Stats objects just stay zero.
+//
+// Stats are collected per job: install a Stats object for the current thread
+// with StatsScope and every instrumented operation executed by this thread
+// within the scope is accounted into it.
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace zp {
+enum class Counter { Add, Sub, Mul, Reduction, Inversion, NumCounters };
+
+enum class Phase {
+  PivotSearch,
+  Inversion,
+  RowSwap,
+  RowUpdate,
+  BackSubstitution,
+  NumPhases
+};
+
+inline const char *name(Counter counter) {
+  switch (counter) {
+  case Counter::Add:
+    return "add";
+  case Counter::Sub:
+    return "sub";
+  case Counter::Mul:
+    return "mul";
+  case Counter::Reduction:
+    return "reduction";
+  case Counter::Inversion:
+    return "inversion";
+  default:
+    return "";
+  }
+}
+
+inline const char *name(Phase phase) {
+  switch (phase) {
+  case Phase::PivotSearch:
+    return "pivot_search";
+  case Phase::Inversion:
+    return "inversion";
+  case Phase::RowSwap:
+    return "row_swap";
+  case Phase::RowUpdate:
+    return "row_update";
+  case Phase::BackSubstitution:
+    return "back_substitution";
+  default:
+    return "";
+  }
+}
+
+struct Stats {
+  static constexpr int NumCounters = int(Counter::NumCounters);
+  static constexpr int NumPhases = int(Phase::NumPhases);
+
+  std::array<uint64_t, NumCounters> counters{};
+  std::array<uint64_t, NumPhases> phase_calls{};
+  std::array<uint64_t, NumPhases> phase_ns{};
+
+  uint64_t count(Counter counter) const { return counters[int(counter)]; }
+  uint64_t calls(Phase phase) const { return phase_calls[int(phase)]; }
+  double seconds(Phase phase) const { return phase_ns[int(phase)] * 1e-9; }
+
+  void reset() { *this = Stats(); }
+
+  Stats &operator+=(const Stats &other) {
+    for (int i = 0; i < NumCounters; ++i)
+      counters[i] += other.counters[i];
+    for (int i = 0; i < NumPhases; ++i) {
+      phase_calls[i] += other.phase_calls[i];
+      phase_ns[i] += other.phase_ns[i];
+    }
+    return *this;
+  }
+
+  std::ostream &to_json(std::ostream &o) const {
+    o << "{\"counters\":{";
+    for (int i = 0; i < NumCounters; ++i)
+      o << (i ? "," : "") << '"' << name(Counter(i)) << "\":" << counters[i];
+    o << "},\"phases\":{";
+    for (int i = 0; i < NumPhases; ++i)
+      o << (i ? "," : "") << '"' << name(Phase(i)) << "\":{\"calls\":"
+        << phase_calls[i] << ",\"ns\":" << phase_ns[i] << '}';
+    return o << "}}";
+  }
+
+  std::string json() const {
+    std::ostringstream o;
+    to_json(o);
+    return o.str();
+  }
+};
+
+inline Stats *&current_stats() {
+  thread_local Stats *stats = nullptr;
+  return stats;
+}
+
+// Routes instrumentation of the current thread into stats until destroyed
+class StatsScope {
+public:
+  explicit StatsScope(Stats &stats) : previous(current_stats()) {
+    current_stats() = &stats;
+  }
+  ~StatsScope() { current_stats() = previous; }
+
+  StatsScope(const StatsScope &) = delete;
+  StatsScope &operator=(const StatsScope &) = delete;
+
+private:
+  Stats *previous;
+};
+
+#ifdef ZP_ELIMINATOR_INSTRUMENTATION
+inline constexpr bool InstrumentationEnabled = true;
+
+inline void count(Counter counter, uint64_t n = 1) {
+  if (Stats *stats = current_stats())
+    stats->counters[int(counter)] += n;
+}
+
+class PhaseTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+  explicit PhaseTimer(Phase phase)
+      : stats(current_stats()), phase(phase), start(Clock::now()) {}
+  ~PhaseTimer() {
+    if (!stats)
+      return;
+    const auto elapsed = Clock::now() - start;
+    stats->phase_calls[int(phase)] += 1;
+    stats->phase_ns[int(phase)] +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  }
+
+  PhaseTimer(const PhaseTimer &) = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+
+private:
+  Stats *stats;
+  Phase phase;
+  Clock::time_point start;
+};
+#else
+inline constexpr bool InstrumentationEnabled = false;
+
+inline void count(Counter, uint64_t = 1) {}
+
+class PhaseTimer {
+public:
+  explicit PhaseTimer(Phase) {}
+};
+#endif
+} // namespace zp
+
+#endif
@@ -1,10 +1,12 @@
 #ifndef VECTOR_KERNELS_HPP
 #define VECTOR_KERNELS_HPP
 
+#include <algorithm>
 #include <cstdint>
 
 #include <immintrin.h>
 
+#include "zp_eliminator/stats.hpp"
 #include "zp_eliminator/zp_scalar.hpp"
 
 namespace zp {
@@ -25,6 +27,7 @@ template <uint16_t P> struct VecAddOp<uint16_t, 16, P> {
 
   inline static void run(const uint16_t *ap, const uint16_t *bp, uint16_t *cp,
                          size_t N) {
+    count(Counter::Add, N);
     __m256i p = _mm256_set1_epi16(P);
     for (size_t i = 0; i < N; i += 16) {
       __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(ap + i));
@@ -36,6 +39,7 @@ template <uint16_t P> struct VecAddOp<uint16_t, 16, P> {
 
   inline static void run(const Zp *ap, const Zp *bp, Zp *cp, size_t N) {
     static_assert(sizeof(Zp) == sizeof(Word));
+    count(Counter::Add, N);
     __m256i p = _mm256_set1_epi16(P);
     for (size_t i = 0; i < N; i += 16) {
       __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(ap + i));
@@ -62,6 +66,7 @@ template <uint16_t P> struct VecSubOp<uint16_t, 16, P> {
 
   inline static void run(const uint16_t *ap, const uint16_t *bp, uint16_t *cp,
                          size_t N) {
+    count(Counter::Sub, N);
     __m256i p = _mm256_set1_epi16(P);
     __m256i z = _mm256_setzero_si256();
     for (size_t i = 0; i < N; i += 16) {
@@ -78,6 +83,279 @@ template <uint16_t P> struct VecSubOp<uint16_t, 16, P> {
         reinterpret_cast<Word *>(cp), N);
   }
 };
+
+// Vectorized DivMod::Mod of eight 32-bit lanes not exceeding MaxMultiply
+template <uint16_t P, uint32_t MaxMultiply> struct VecDivMod {
+  using Traits = div_mod_trait<uint16_t, P, MaxMultiply>;
+  static constexpr int Shift = Traits::W_DWord + Traits::L - 1;
+  // Multiplier has to fit into 32-bit lanes of _mm256_mul_epu32
+  static_assert(Traits::J <= ~uint32_t(0));
+
+  inline static __m256i j() { return _mm256_set1_epi32(uint32_t(Traits::J)); }
+  inline static __m256i p() { return _mm256_set1_epi32(P); }
+
+  inline static __m256i reduce(const __m256i &x, const __m256i &j,
+                               const __m256i &p) {
+    __m256i corrected = x;
+    if constexpr (Traits::CheckRequired && P % 2) {
+      if constexpr (MaxMultiply <= uint32_t(INT32_MAX)) {
+        const __m256i nc = _mm256_set1_epi32(uint32_t(Traits::Nc - 1));
+        corrected = _mm256_add_epi32(x, _mm256_cmpgt_epi32(x, nc));
+      } else {
+        const __m256i nc = _mm256_set1_epi32(uint32_t(Traits::Nc));
+        const __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(x, nc), x);
+        corrected = _mm256_add_epi32(x, ge);
+      }
+    } else if constexpr (Traits::CheckRequired) {
+      corrected = _mm256_andnot_si256(_mm256_set1_epi32(1), x);
+    }
+    const __m256i q_even =
+        _mm256_srli_epi64(_mm256_mul_epu32(corrected, j), Shift);
+    const __m256i q_odd = _mm256_srli_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(corrected, 32), j), Shift - 32);
+    const __m256i q = _mm256_blend_epi32(q_even, q_odd, 0xAA);
+    return _mm256_sub_epi32(x, _mm256_mullo_epi32(q, p));
+  }
+};
+
+template <typename Word, int Width, Word P> struct VecMulOp;
+
+template <uint16_t P> struct VecMulOp<uint16_t, 16, P> {
+  using Word = uint16_t;
+  using DWord = uint32_t;
+  using Zp = ZpScalar<P, Word>;
+  static constexpr DWord MaxMul = DWord(P) * (P - 1);
+  using DivModT = VecDivMod<P, MaxMul>;
+
+  inline static __m256i j() { return DivModT::j(); }
+  inline static __m256i p() { return DivModT::p(); }
+
+  inline static __m256i reduce(const __m256i &x, const __m256i &j,
+                               const __m256i &p) {
+    return DivModT::reduce(x, j, p);
+  }
+
+  inline static __m256i run(const __m256i &a, const __m256i &b,
+                            const __m256i &j, const __m256i &p) {
+    const __m256i lo = _mm256_mullo_epi16(a, b);
+    const __m256i hi = _mm256_mulhi_epu16(a, b);
+    // unpack & pack work within 128-bit lanes and restore the original order
+    const __m256i r0 = reduce(_mm256_unpacklo_epi16(lo, hi), j, p);
+    const __m256i r1 = reduce(_mm256_unpackhi_epi16(lo, hi), j, p);
+    return _mm256_packus_epi32(r0, r1);
+  }
+
+  inline static void run(const uint16_t *ap, const uint16_t *bp, uint16_t *cp,
+                         size_t N) {
+    count(Counter::Mul, N);
+    __m256i vj = j();
+    __m256i vp = p();
+    for (size_t i = 0; i < N; i += 16) {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(ap + i));
+      __m256i b = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(bp + i));
+      __m256i c = run(a, b, vj, vp);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(cp + i), c);
+    }
+  }
+
+  inline static void run(const Zp *ap, const Zp *bp, Zp *cp, size_t N) {
+    static_assert(sizeof(Zp) == sizeof(Word));
+    run(reinterpret_cast<const Word *>(ap), reinterpret_cast<const Word *>(bp),
+        reinterpret_cast<Word *>(cp), N);
+  }
+};
+
+// row[i] -= f * pivot[i], elimination step of a row by a pivot row
+template <typename Word, int Width, Word P> struct VecRowUpdateOp;
+
+template <uint16_t P> struct VecRowUpdateOp<uint16_t, 16, P> {
+  using Word = uint16_t;
+  using Zp = ZpScalar<P, Word>;
+  using Sub = VecSubOp<uint16_t, 16, P>;
+  using Mul = VecMulOp<uint16_t, 16, P>;
+
+  inline static void run(const Zp *pivot, const Zp &f, Zp *row, size_t N) {
+    static_assert(sizeof(Zp) == sizeof(Word));
+    // the scalar tail is counted by ZpScalar
+    count(Counter::Mul, N - N % 16);
+    count(Counter::Sub, N - N % 16);
+    const __m256i vf = _mm256_set1_epi16(f.value());
+    const __m256i j = Mul::j();
+    const __m256i p32 = Mul::p();
+    const __m256i p = _mm256_set1_epi16(P);
+    const __m256i z = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 16 <= N; i += 16) {
+      __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(pivot + i));
+      __m256i r = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(row + i));
+      __m256i c = Sub::run(r, Mul::run(vf, a, j, p32), p, z);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + i), c);
+    }
+    for (; i < N; ++i)
+      row[i] -= f * pivot[i];
+  }
+};
+
+// row[i] *= f
+template <typename Word, int Width, Word P> struct VecScaleOp;
+
+template <uint16_t P> struct VecScaleOp<uint16_t, 16, P> {
+  using Word = uint16_t;
+  using Zp = ZpScalar<P, Word>;
+  using Mul = VecMulOp<uint16_t, 16, P>;
+
+  inline static void run(const Zp &f, Zp *row, size_t N) {
+    static_assert(sizeof(Zp) == sizeof(Word));
+    count(Counter::Mul, N - N % 16);
+    const __m256i vf = _mm256_set1_epi16(f.value());
+    const __m256i j = Mul::j();
+    const __m256i p = Mul::p();
+    size_t i = 0;
+    for (; i + 16 <= N; i += 16) {
+      __m256i r = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(row + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + i),
+                          Mul::run(vf, r, j, p));
+    }
+    for (; i < N; ++i)
+      row[i] *= f;
+  }
+};
+
+// x^e for 16 points at once, using the sliding-window schedule of ZpScalar::pow
+template <typename Word, int Width, Word P> struct VecPowOp;
+
+template <uint16_t P> struct VecPowOp<uint16_t, 16, P> {
+  using Word = uint16_t;
+  using Zp = ZpScalar<P, Word>;
+  using Mul = VecMulOp<uint16_t, 16, P>;
+
+  inline static __m256i run(const __m256i &x, const PowSchedule &schedule,
+                            const __m256i &j, const __m256i &p) {
+    if (!schedule.length)
+      return _mm256_set1_epi16(1);
+    __m256i table[PowSchedule::MaxTableSize];
+    const __m256i square = Mul::run(x, x, j, p);
+    table[0] = x;
+    for (int i = 1; i < schedule.table_size(); ++i)
+      table[i] = Mul::run(table[i - 1], square, j, p);
+
+    __m256i res = table[schedule.steps[0].odd / 2];
+    for (int i = 1; i < schedule.length; ++i) {
+      const PowStep &step = schedule.steps[i];
+      for (int k = 0; k < step.squarings; ++k)
+        res = Mul::run(res, res, j, p);
+      res = Mul::run(res, table[step.odd / 2], j, p);
+    }
+    for (int i = 0; i < schedule.tail; ++i)
+      res = Mul::run(res, res, j, p);
+    return res;
+  }
+
+  inline static void run(const Zp *xp, uint64_t e, Zp *cp, size_t N) {
+    static_assert(sizeof(Zp) == sizeof(Word));
+    const PowSchedule schedule = make_pow_schedule(e);
+    // the scalar tail is counted by ZpScalar
+    count(Counter::Mul, (N - N % 16) * schedule.multiplications());
+    const __m256i j = Mul::j();
+    const __m256i p = Mul::p();
+    size_t i = 0;
+    for (; i + 16 <= N; i += 16) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(xp + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(cp + i),
+                          run(x, schedule, j, p));
+    }
+    for (; i < N; ++i)
+      cp[i] = xp[i].pow(schedule);
+  }
+};
+
+// Evaluates polynomial sum_k coeffs[k] x^k (degree = num_coeffs - 1) at N
+// points with Horner's rule. Four registers are processed at once to hide the
+// latency of the multiplication.
+template <typename Word, int Width, Word P> struct VecHornerOp;
+
+template <uint16_t P> struct VecHornerOp<uint16_t, 16, P> {
+  using Word = uint16_t;
+  using Zp = ZpScalar<P, Word>;
+  using Add = VecAddOp<uint16_t, 16, P>;
+  using Mul = VecMulOp<uint16_t, 16, P>;
+  static constexpr int Unroll = 4;
+
+  inline static void run(const Zp *coeffs, size_t num_coeffs, const Zp *xp,
+                         Zp *cp, size_t N) {
+    static_assert(sizeof(Zp) == sizeof(Word));
+    if (!num_coeffs) {
+      std::fill(cp, cp + N, Zp(0));
+      return;
+    }
+    count(Counter::Mul, (N - N % 16) * (num_coeffs - 1));
+    count(Counter::Add, (N - N % 16) * (num_coeffs - 1));
+    const __m256i j = Mul::j();
+    const __m256i p32 = Mul::p();
+    const __m256i p = _mm256_set1_epi16(P);
+    const __m256i leading = _mm256_set1_epi16(coeffs[num_coeffs - 1].value());
+
+    size_t i = 0;
+    for (; i + 16 * Unroll <= N; i += 16 * Unroll) {
+      __m256i x[Unroll], acc[Unroll];
+      for (int u = 0; u < Unroll; ++u) {
+        x[u] = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const *>(xp + i + 16 * u));
+        acc[u] = leading;
+      }
+      for (size_t k = num_coeffs - 1; k-- > 0;) {
+        const __m256i c = _mm256_set1_epi16(coeffs[k].value());
+        for (int u = 0; u < Unroll; ++u)
+          acc[u] = Add::run(Mul::run(acc[u], x[u], j, p32), c, p);
+      }
+      for (int u = 0; u < Unroll; ++u)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(cp + i + 16 * u),
+                            acc[u]);
+    }
+    for (; i + 16 <= N; i += 16) {
+      const __m256i x =
+          _mm256_loadu_si256(reinterpret_cast<__m256i const *>(xp + i));
+      __m256i acc = leading;
+      for (size_t k = num_coeffs - 1; k-- > 0;)
+        acc = Add::run(Mul::run(acc, x, j, p32),
+                       _mm256_set1_epi16(coeffs[k].value()), p);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(cp + i), acc);
+    }
+    for (; i < N; ++i) {
+      Zp acc = coeffs[num_coeffs - 1];
+      for (size_t k = num_coeffs - 1; k-- > 0;)
+        acc = acc * xp[i] + coeffs[k];
+      cp[i] = acc;
+    }
+  }
+};
+
+// Row operations used by elimination routines; 16-bit words go through the
+// AVX2 kernels above, wider words fall back to scalar loops
+template <uint64_t prime, typename T>
+inline void row_update(const ZpScalar<prime, T> *pivot,
+                       const ZpScalar<prime, T> &f, ZpScalar<prime, T> *row,
+                       size_t N) {
+  using Word = typename ZpScalar<prime, T>::Word;
+  if constexpr (sizeof(Word) == 2) {
+    VecRowUpdateOp<Word, 16, Word(prime)>::run(pivot, f, row, N);
+  } else {
+    for (size_t i = 0; i < N; ++i)
+      row[i] -= f * pivot[i];
+  }
+}
+
+template <uint64_t prime, typename T>
+inline void row_scale(const ZpScalar<prime, T> &f, ZpScalar<prime, T> *row,
+                      size_t N) {
+  using Word = typename ZpScalar<prime, T>::Word;
+  if constexpr (sizeof(Word) == 2) {
+    VecScaleOp<Word, 16, Word(prime)>::run(f, row, N);
+  } else {
+    for (size_t i = 0; i < N; ++i)
+      row[i] *= f;
+  }
+}
 } // namespace zp
 
 #endif
@@ -22,8 +22,13 @@ SOFTWARE.
 #ifndef ZP_SCALAR_HPP
 #define ZP_SCALAR_HPP
 
+#include <array>
+#include <bit>
 #include <cstdint>
 #include <iosfwd>
+#include <utility>
+
+#include "zp_eliminator/stats.hpp"
 
 namespace zp {
 template <typename word> struct dword_type;
@@ -32,7 +37,7 @@ template <> struct dword_type<uint16_t> { using type = uint32_t; };
 
 template <> struct dword_type<uint32_t> { using type = uint64_t; };
 
-template <> struct dword_type<uint64_t> { using type = __int128; };
+template <> struct dword_type<uint64_t> { using type = unsigned __int128; };
 
 template <typename T> using dword_type_t = typename dword_type<T>::type;
 
@@ -110,6 +115,8 @@ struct direct_mod_trait {
   static constexpr bool AddMode = rem >= cmn;
 
   static constexpr QWord C = AddMode ? M / D : (M - 1) / D + 1;
+  // C * dividend and the masked fraction times D have to fit into QWord
+  static constexpr bool Valid = 2 * LM <= W_QWord && 2 * L + LM <= W_QWord;
 };
 
 template <typename Word, Word Divisor, dword_type_t<Word> MaxMultiply,
@@ -136,6 +143,7 @@ struct DirectMod2;
 template <typename Word, Word Divisor, dword_type_t<Word> MaxMultiply>
 struct DirectMod2<Word, Divisor, MaxMultiply, true> {
   using Traits = direct_mod_trait<Word, Divisor, MaxMultiply>;
+  static_assert(Traits::Valid);
   using DWord = typename Traits::DWord;
   using QWord = typename Traits::QWord;
   static constexpr int Shift = Traits::W_QWord - (Traits::L + Traits::LM);
@@ -151,6 +159,7 @@ struct DirectMod2<Word, Divisor, MaxMultiply, true> {
 template <typename Word, Word Divisor, dword_type_t<Word> MaxMultiply>
 struct DirectMod2<Word, Divisor, MaxMultiply, false> {
   using Traits = direct_mod_trait<Word, Divisor, MaxMultiply>;
+  static_assert(Traits::Valid);
   using DWord = typename Traits::DWord;
   using QWord = typename Traits::QWord;
   static constexpr int Shift = Traits::W_QWord - (Traits::L + Traits::LM);
@@ -199,7 +208,7 @@ struct DivMod<Word, Divisor, MaxMultiply, true, true> {
   using QWord = typename Traits::QWord;
   // Divisor is odd, need to check for correction
   static Word Divide(const DWord &dividend) {
-    const DWord corrected = dividend >= Traits::Nc ? dividend - 1 : dividend;
+    const DWord corrected = dividend - DWord(dividend >= Traits::Nc);
     return (corrected * Traits::J) >> (Traits::W_DWord + Traits::L - 1);
   }
   static Word Mod(const DWord &dividend) {
@@ -207,9 +216,84 @@ struct DivMod<Word, Divisor, MaxMultiply, true, true> {
   }
 };
 
-enum class MulAlgo { Explicit, MulShift, MulShiftDirect, MulShiftDirect2 };
+enum class MulAlgo { Explicit, MulShift, MulShiftDirect, MulShiftDirect2, Auto };
 template <typename Word, Word P, MulAlgo algo> struct MulOp;
 
+// Per-prime choice produced by tools/zp_autotune; takes precedence over the
+// cost model below when available.
+template <typename Word, Word P> struct tuned_mul_algo {
+  static constexpr bool Available = false;
+};
+
+// Cost of a word x word -> word modular product in units of ~0.1 ns, measured
+// with tools/zp_autotune (independent dependency chains of products) on an
+// AVX2 desktop core. Base costs are per word width, the trait-dependent extras
+// are what separates primes of the same width in those measurements.
+struct mul_cost_model {
+  // {16-bit words, 32-bit words}
+  static constexpr int Explicit[] = {14, 14};
+  static constexpr int MulShift[] = {16, 15};
+  static constexpr int MulShiftDirect[] = {13, -1};
+  static constexpr int MulShiftDirect2[] = {14, 18};
+  // Extra add & shift emitted by compilers when the magic constant does not
+  // fit into the word
+  static constexpr int FixUp = 5;
+  // Correction of the dividend for odd divisors
+  static constexpr int Select = 2;
+  // Increment of the dividend in the "add" variant of direct remainder
+  static constexpr int AddMode = 1;
+};
+
+template <typename Word, Word P> constexpr int mul_algo_cost(MulAlgo algo) {
+  using Cost = mul_cost_model;
+  constexpr int W = integer_traits<Word>::NumBits;
+  static_assert(W == 16 || W == 32, "No measured costs for this word size");
+  constexpr int w = W == 16 ? 0 : 1;
+  using DWord = dword_type_t<Word>;
+  constexpr DWord MaxMul = DWord(P) * (P - 1);
+  switch (algo) {
+  case MulAlgo::Explicit:
+    // Compiler-generated division by constant has to be exact for any DWord
+    return Cost::Explicit[w] +
+           (div_mod_trait<Word, P, ~DWord(0)>::CheckRequired ? Cost::FixUp
+                                                             : 0);
+  case MulAlgo::MulShift:
+    return Cost::MulShift[w] +
+           (div_mod_trait<Word, P, MaxMul>::CheckRequired ? Cost::Select : 0);
+  case MulAlgo::MulShiftDirect:
+    // Requires an integer type twice as wide as QWord
+    return Cost::MulShiftDirect[w];
+  case MulAlgo::MulShiftDirect2:
+    if (!direct_mod_trait<Word, P, MaxMul>::Valid)
+      return -1;
+    return Cost::MulShiftDirect2[w] +
+           (direct_mod_trait<Word, P, MaxMul>::AddMode ? Cost::AddMode : 0);
+  default:
+    return -1;
+  }
+}
+
+// Picks the cheapest algorithm, preferring the earlier candidate on ties
+template <typename Word, Word P> constexpr MulAlgo auto_mul_algo() {
+  if constexpr (tuned_mul_algo<Word, P>::Available) {
+    return tuned_mul_algo<Word, P>::value;
+  } else {
+    constexpr MulAlgo candidates[] = {MulAlgo::MulShift, MulAlgo::Explicit,
+                                      MulAlgo::MulShiftDirect2,
+                                      MulAlgo::MulShiftDirect};
+    MulAlgo best = MulAlgo::MulShift;
+    int best_cost = mul_algo_cost<Word, P>(MulAlgo::MulShift);
+    for (const MulAlgo algo : candidates) {
+      const int cost = mul_algo_cost<Word, P>(algo);
+      if (cost >= 0 && cost < best_cost) {
+        best = algo;
+        best_cost = cost;
+      }
+    }
+    return best;
+  }
+}
+
 template <typename Word, Word P> struct MulOp<Word, P, MulAlgo::Explicit> {
   using DWord = dword_type_t<Word>;
   Word operator()(const Word &a, const Word &b) const {
@@ -249,7 +333,11 @@ struct MulOp<Word, P, MulAlgo::MulShiftDirect2> {
   }
 };
 
-enum class PlusMinusAlgo { Explicit, CondSub };
+template <typename Word, Word P>
+struct MulOp<Word, P, MulAlgo::Auto> : MulOp<Word, P, auto_mul_algo<Word, P>()> {
+};
+
+enum class PlusMinusAlgo { Explicit, CondSub, Branchless };
 template <typename Word, Word P, PlusMinusAlgo algo> struct AddOp;
 template <typename Word, Word P, PlusMinusAlgo algo> struct SubOp;
 
@@ -267,6 +355,18 @@ template <typename Word, Word P> struct AddOp<Word, P, PlusMinusAlgo::CondSub> {
   }
 };
 
+// Correction by p is selected with a mask derived from the sign bit of the
+// (wrapped) difference instead of a comparison
+template <typename Word, Word P>
+struct AddOp<Word, P, PlusMinusAlgo::Branchless> {
+  static constexpr int SignBit = integer_traits<Word>::NumBits - 1;
+  Word operator()(const Word &a, const Word &b) const {
+    const Word diff = Word(a + b) - P;
+    const Word mask = Word(0) - Word(diff >> SignBit);
+    return diff + Word(P & mask);
+  }
+};
+
 template <typename Word, Word P>
 struct SubOp<Word, P, PlusMinusAlgo::Explicit> {
   Word operator()(const Word &a, const Word &b) const {
@@ -283,7 +383,102 @@ template <typename Word, Word P> struct SubOp<Word, P, PlusMinusAlgo::CondSub> {
   }
 };
 
-template <uint64_t prime, typename T = minimal_type_t<prime>> struct ZpScalar {
+template <typename Word, Word P>
+struct SubOp<Word, P, PlusMinusAlgo::Branchless> {
+  static constexpr int SignBit = integer_traits<Word>::NumBits - 1;
+  Word operator()(const Word &a, const Word &b) const {
+    const Word diff = a - b;
+    const Word mask = Word(0) - Word(diff >> SignBit);
+    return diff + Word(P & mask);
+  }
+};
+
+// Sliding-window exponentiation schedule: starting from the odd power
+// x^steps[0].odd, each step squares the result steps[i].squarings times and
+// multiplies it by x^steps[i].odd, the result is squared tail times afterwards.
+struct PowStep {
+  int squarings;
+  uint32_t odd;
+};
+
+struct PowSchedule {
+  static constexpr int MaxSteps = 64;
+  static constexpr int MaxWindow = 4;
+  static constexpr int MaxTableSize = 1 << (MaxWindow - 1);
+  int window = 0;
+  int length = 0;
+  int tail = 0;
+  uint32_t max_odd = 1;
+  std::array<PowStep, MaxSteps> steps{};
+
+  // Number of odd powers x, x^3, ..., x^max_odd
+  constexpr int table_size() const { return (max_odd + 1) / 2; }
+
+  // Multiplications (squarings included) per exponentiation, table included
+  constexpr int multiplications() const {
+    if (!length)
+      return 0;
+    int total = table_size() + tail;
+    for (int i = 1; i < length; ++i)
+      total += steps[i].squarings + 1;
+    return total;
+  }
+};
+
+// Window width for an exponent of a given bit length
+constexpr int pow_window(int bits) {
+  return bits <= 8 ? 2 : bits <= 24 ? 3 : PowSchedule::MaxWindow;
+}
+
+// Odd value of the widest window of e (at most `window` bits) whose highest bit
+// is the set bit i; its lowest bit is stored to j
+constexpr uint32_t pow_odd_window(uint64_t e, int i, int window, int &j) {
+  j = i - window + 1 > 0 ? i - window + 1 : 0;
+  const uint64_t bits = (e >> j) & ((uint64_t(2) << (i - j)) - 1);
+  const int zeros = std::countr_zero(bits);
+  j += zeros;
+  return bits >> zeros;
+}
+
+constexpr PowSchedule make_pow_schedule(uint64_t e) {
+  PowSchedule s;
+  const int bits = num_bits(e);
+  s.window = pow_window(bits);
+  int pending = 0;
+  for (int i = bits - 1; i >= 0;) {
+    if (!((e >> i) & 1)) {
+      ++pending;
+      --i;
+      continue;
+    }
+    int j = 0;
+    const uint32_t odd = pow_odd_window(e, i, s.window, j);
+    s.steps[s.length++] = {pending + i - j + 1, odd};
+    s.max_odd = odd > s.max_odd ? odd : s.max_odd;
+    pending = 0;
+    i = j - 1;
+  }
+  s.tail = pending;
+  return s;
+}
+
+struct DefaultPolicy {
+  static constexpr PlusMinusAlgo PlusMinus = PlusMinusAlgo::CondSub;
+  static constexpr MulAlgo Mul = MulAlgo::Auto;
+  static constexpr bool ConstantTime = false;
+};
+
+// Arithmetic and inversion do not branch on values; comparison and conversion
+// to bool obviously do.
+struct ConstantTimePolicy {
+  static constexpr PlusMinusAlgo PlusMinus = PlusMinusAlgo::Branchless;
+  static constexpr MulAlgo Mul = MulAlgo::Auto;
+  static constexpr bool ConstantTime = true;
+};
+
+template <uint64_t prime, typename T = minimal_type_t<prime>,
+          typename Policy = DefaultPolicy>
+struct ZpScalar {
   using Word = T;
   using DWord = dword_type_t<T>;
   static constexpr Word P = prime;
@@ -291,23 +486,31 @@ template <uint64_t prime, typename T = minimal_type_t<prime>> struct ZpScalar {
   ZpScalar(const Word &v) : v(v) {}
 
   ZpScalar operator-() const {
-    if (!v)
-      return *this;
-    return P - v;
+    count(Counter::Sub);
+    if constexpr (Policy::ConstantTime) {
+      return SubOp<Word, P, Policy::PlusMinus>()(0, v);
+    } else {
+      if (!v)
+        return *this;
+      return P - v;
+    }
   }
 
-  template <PlusMinusAlgo algorithm = PlusMinusAlgo::CondSub>
+  template <PlusMinusAlgo algorithm = Policy::PlusMinus>
   ZpScalar operator+(const ZpScalar &other) const {
+    count(Counter::Add);
     return AddOp<Word, P, algorithm>()(v, other.v);
   }
 
-  template <PlusMinusAlgo algorithm = PlusMinusAlgo::CondSub>
+  template <PlusMinusAlgo algorithm = Policy::PlusMinus>
   ZpScalar operator-(const ZpScalar &other) const {
+    count(Counter::Sub);
     return SubOp<Word, P, algorithm>()(v, other.v);
   }
 
-  template <MulAlgo algorithm = MulAlgo::MulShift>
+  template <MulAlgo algorithm = Policy::Mul>
   ZpScalar operator*(const ZpScalar &other) const {
+    count(Counter::Mul);
     return MulOp<Word, P, algorithm>()(v, other.v);
   }
 
@@ -336,35 +539,125 @@ template <uint64_t prime, typename T = minimal_type_t<prime>> struct ZpScalar {
 
   operator bool() const { return v; }
 
+  // The schedule of pow<P - 2>() depends only on P, so the sequence of
+  // operations is the same for every value, including in constant-time mode
   ZpScalar inverse() const {
-    Word pow = P - 2;
-    ZpScalar exp(v);
-    ZpScalar res(1);
-    while (pow) {
-      if (pow & 1)
-        res *= exp;
-      exp *= exp;
-      pow >>= 1;
+    count(Counter::Inversion);
+    return pow<P - 2>();
+  }
+
+  // Left-to-right sliding window, windows are scanned on the fly and only the
+  // table of odd powers is kept
+  ZpScalar pow(uint64_t e) const {
+    if (!e)
+      return 1;
+    const int bits = std::bit_width(e);
+    const int window = pow_window(bits);
+    ZpScalar table[PowSchedule::MaxTableSize];
+    odd_powers(table, 1 << (window - 1));
+    int j = 0;
+    ZpScalar res = table[pow_odd_window(e, bits - 1, window, j) / 2];
+    for (int i = j - 1; i >= 0; i = j - 1) {
+      // zero bits are skipped at once and squared together with the window
+      const uint64_t rest = e & ((uint64_t(2) << i) - 1);
+      uint32_t odd = 0;
+      j = 0;
+      if (rest)
+        odd = pow_odd_window(e, std::bit_width(rest) - 1, window, j);
+      for (int k = j; k <= i; ++k)
+        res *= res;
+      if (odd)
+        res *= table[odd / 2];
     }
     return res;
   }
 
-  static ZpScalar Fit(const Word &v) { return v % P; }
+  // Exponentiation by a precomputed schedule, for exponents shared by many
+  // bases
+  ZpScalar pow(const PowSchedule &schedule) const {
+    if (!schedule.length)
+      return 1;
+    ZpScalar table[PowSchedule::MaxTableSize];
+    odd_powers(table, schedule.table_size());
+    ZpScalar res = table[schedule.steps[0].odd / 2];
+    for (int i = 1; i < schedule.length; ++i)
+      res = pow_step(res, schedule.steps[i], table);
+    for (int i = 0; i < schedule.tail; ++i)
+      res *= res;
+    return res;
+  }
+
+  // Exponent known at compile time: schedule is computed by the compiler and
+  // the multiplication chain is fully unrolled
+  template <uint64_t E> ZpScalar pow() const {
+    constexpr PowSchedule schedule = make_pow_schedule(E);
+    if constexpr (!schedule.length) {
+      return 1;
+    } else {
+      std::array<ZpScalar, schedule.table_size()> table;
+      odd_powers(table.data(), table.size());
+      ZpScalar res = table[schedule.steps[0].odd / 2];
+      res = pow_unrolled<E>(res, table.data(),
+                            std::make_index_sequence<schedule.length - 1>());
+      for (int i = 0; i < schedule.tail; ++i)
+        res *= res;
+      return res;
+    }
+  }
+
+  static ZpScalar Fit(const Word &v) {
+    count(Counter::Reduction);
+    return v % P;
+  }
 
   ZpScalar &operator=(const ZpScalar &s) = default;
 
-  template <uint64_t p, typename S>
-  friend std::ostream &operator<<(std::ostream &o, const ZpScalar<p, S> &z);
+  template <uint64_t p, typename S, typename Q>
+  friend std::ostream &operator<<(std::ostream &o, const ZpScalar<p, S, Q> &z);
 
   Word value() const { return v; }
 
 private:
+  // x, x^3, x^5, ...
+  void odd_powers(ZpScalar *table, int size) const {
+    const ZpScalar square = *this * *this;
+    table[0] = *this;
+    for (int i = 1; i < size; ++i)
+      table[i] = table[i - 1] * square;
+  }
+
+  static ZpScalar pow_step(ZpScalar res, const PowStep &step,
+                           const ZpScalar *table) {
+    for (int i = 0; i < step.squarings; ++i)
+      res *= res;
+    return res * table[step.odd / 2];
+  }
+
+  template <uint64_t E, size_t... I>
+  static ZpScalar pow_unrolled(ZpScalar res,
+                               [[maybe_unused]] const ZpScalar *table,
+                               std::index_sequence<I...>) {
+    [[maybe_unused]] constexpr PowSchedule schedule = make_pow_schedule(E);
+    ((res = pow_step(res, schedule.steps[I + 1], table)), ...);
+    return res;
+  }
+
   Word v;
 };
 
-template <uint64_t prime, typename T>
-std::ostream &operator<<(std::ostream &o, const ZpScalar<prime, T> &z) {
+template <uint64_t prime>
+using ConstantTimeZpScalar =
+    ZpScalar<prime, minimal_type_t<prime>, ConstantTimePolicy>;
+
+template <uint64_t prime, typename T, typename Policy>
+std::ostream &operator<<(std::ostream &o,
+                         const ZpScalar<prime, T, Policy> &z) {
   return o << z.v;
 }
 } // namespace zp
+
+#ifdef ZP_ELIMINATOR_TUNED_MUL_HEADER
+#include ZP_ELIMINATOR_TUNED_MUL_HEADER
+#endif
+
 #endif
@@ -0,0 +1,50 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#ifndef ZP_TESTS_RANDOM_MATRIX_HPP
+#define ZP_TESTS_RANDOM_MATRIX_HPP
+
+#include <zp_eliminator/random.hpp>
+#include <zp_eliminator/zp_scalar.hpp>
+
+#include <vector>
+
+namespace zp {
+// Row-major rows x cols matrix of a given rank (with overwhelming
+// probability): product of random rows x rank and rank x cols factors
+template <uint64_t prime>
+std::vector<ZpScalar<prime>> random_matrix(int rows, int cols, int rank,
+                                           uint64_t stream) {
+  using Zp = ZpScalar<prime>;
+  RandomZp<prime> random(stream);
+  std::vector<Zp> left(size_t(rows) * rank), right(size_t(rank) * cols);
+  random.fill(left.data(), left.size());
+  random.fill(right.data(), right.size());
+  std::vector<Zp> a(size_t(rows) * cols, Zp(0));
+  for (int i = 0; i < rows; ++i)
+    for (int k = 0; k < rank; ++k)
+      for (int j = 0; j < cols; ++j)
+        a[i * cols + j] += left[i * rank + k] * right[k * cols + j];
+  return a;
+}
+} // namespace zp
+
+#endif
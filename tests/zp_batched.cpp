@@ -0,0 +1,152 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <zp_eliminator/batched.hpp>
+
+#include "random_matrix.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace zp;
+
+const uint16_t P = 32749;
+using ZP = ZpScalar<P>;
+using Matrices = BatchedMatrices<P>;
+
+// Reference rank via scalar Gaussian elimination
+int reference_rank(std::vector<std::vector<ZP>> a) {
+  const int n = a.size(), m = a[0].size();
+  int rank = 0;
+  for (int c = 0; c < m && rank < n; ++c) {
+    int pivot = rank;
+    while (pivot < n && !a[pivot][c])
+      ++pivot;
+    if (pivot == n)
+      continue;
+    std::swap(a[rank], a[pivot]);
+    const ZP inv = a[rank][c].inverse();
+    for (int r = rank + 1; r < n; ++r) {
+      const ZP f = a[r][c] * inv;
+      for (int j = c; j < m; ++j)
+        a[r][j] -= f * a[rank][j];
+    }
+    ++rank;
+  }
+  return rank;
+}
+
+// Stores a random matrix of a given rank as i-th matrix of the batch
+void fill_random(Matrices &A, size_t i, int rank, uint64_t stream) {
+  const int n = A.rows(), m = A.cols();
+  const auto a = random_matrix<P>(n, m, rank, stream);
+  for (int r = 0; r < n; ++r)
+    for (int c = 0; c < m; ++c)
+      A(i, r, c) = a[r * m + c];
+}
+
+TEST_CASE("Batched_Rank") {
+  for (auto [n, m] : {std::pair{8, 8}, {5, 12}, {17, 9}, {32, 32}}) {
+    const size_t count = 37;
+    Matrices A(count, n, m);
+    std::vector<int> expected(count);
+    for (size_t i = 0; i < count; ++i) {
+      fill_random(A, i, i % (std::min(n, m) + 1), n * count + i);
+      std::vector<std::vector<ZP>> a(n, std::vector<ZP>(m));
+      for (int r = 0; r < n; ++r)
+        for (int c = 0; c < m; ++c)
+          a[r][c] = A(i, r, c);
+      expected[i] = reference_rank(a);
+    }
+    std::vector<int> ranks(count, -1);
+    batched_rank(A, ranks.data());
+    for (size_t i = 0; i < count; ++i)
+      CHECK(ranks[i] == expected[i]);
+  }
+}
+
+TEST_CASE("Batched_Solve") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint16_t> runif(0, P - 1);
+  const size_t count = 50;
+  const int n = 12, k = 3;
+  Matrices A(count, n, n), X(count, n, k), B(count, n, k);
+  for (size_t i = 0; i < count; ++i) {
+    // Every 7th matrix is singular
+    fill_random(A, i, i % 7 ? n : n - 1, i);
+    // Zero leading entries force row swaps
+    A(i, 0, 0) = 0;
+    A(i, 1, 1) = 0;
+    for (int r = 0; r < n; ++r)
+      for (int c = 0; c < k; ++c)
+        X(i, r, c) = runif(rng);
+    for (int r = 0; r < n; ++r)
+      for (int c = 0; c < k; ++c) {
+        ZP sum = 0;
+        for (int j = 0; j < n; ++j)
+          sum += A(i, r, j) * X(i, j, c);
+        B(i, r, c) = sum;
+      }
+  }
+
+  bool nonsingular[count];
+  Matrices A_copy = A;
+  batched_solve(A_copy, B, nonsingular);
+  for (size_t i = 0; i < count; ++i) {
+    const bool expected = reference_rank([&] {
+                            std::vector<std::vector<ZP>> a(n,
+                                                           std::vector<ZP>(n));
+                            for (int r = 0; r < n; ++r)
+                              for (int c = 0; c < n; ++c)
+                                a[r][c] = A(i, r, c);
+                            return a;
+                          }()) == n;
+    CHECK(nonsingular[i] == expected);
+    if (!expected)
+      continue;
+    for (int r = 0; r < n; ++r)
+      for (int c = 0; c < k; ++c)
+        CHECK(B(i, r, c) == X(i, r, c));
+  }
+}
+
+TEST_CASE("Batched_Inverse") {
+  const size_t count = 20;
+  const int n = 16;
+  Matrices A(count, n, n);
+  for (size_t i = 0; i < count; ++i)
+    fill_random(A, i, n, i);
+  Matrices inv = A;
+  bool nonsingular[count];
+  batched_inverse(inv, nonsingular);
+  for (size_t i = 0; i < count; ++i) {
+    REQUIRE(nonsingular[i]);
+    for (int r = 0; r < n; ++r)
+      for (int c = 0; c < n; ++c) {
+        ZP sum = 0;
+        for (int j = 0; j < n; ++j)
+          sum += A(i, r, j) * inv(i, j, c);
+        CHECK(sum == ZP(r == c));
+      }
+  }
+}
@@ -0,0 +1,112 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <zp_eliminator/convert.hpp>
+
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+using namespace zp;
+
+template <typename Int, uint64_t P> void check_fit() {
+  using ZP = ZpScalar<P>;
+  using Limits = std::numeric_limits<Int>;
+  const size_t N = 1000;
+  std::vector<Int> in(N);
+  std::mt19937_64 rng(P);
+  using Wide = std::conditional_t<std::is_signed_v<Int>, int64_t, uint64_t>;
+  std::uniform_int_distribution<Wide> runif(Limits::min(), Limits::max());
+  for (auto &v : in)
+    v = runif(rng);
+  const Int edge[] = {Limits::min(), Limits::max(), Int(0), Int(1), Int(-1),
+                      Int(P),        Int(P - 1),    Int(-Int(P))};
+  std::copy(std::begin(edge), std::end(edge), in.begin());
+
+  std::vector<ZP> out(N);
+  fit(in.data(), out.data(), N);
+  for (size_t i = 0; i < N; ++i) {
+    const __int128 v = in[i];
+    const int64_t expected = int64_t((v % __int128(P) + P) % P);
+    CHECK(out[i].value() == expected);
+  }
+}
+
+template <uint64_t P> void check_fit_all() {
+  check_fit<int8_t, P>();
+  check_fit<uint8_t, P>();
+  check_fit<int16_t, P>();
+  check_fit<uint16_t, P>();
+  check_fit<int32_t, P>();
+  check_fit<uint32_t, P>();
+  check_fit<int64_t, P>();
+  check_fit<uint64_t, P>();
+}
+
+TEST_CASE("Fit") {
+  check_fit_all<13>();
+  check_fit_all<251>();
+  check_fit_all<32003>();
+  check_fit_all<32749>();
+  check_fit_all<65521>();
+  check_fit_all<2147483647>();
+}
+
+template <typename Int, uint64_t P> void check_symmetric() {
+  using ZP = ZpScalar<P>;
+  const size_t N = 1000;
+  std::vector<ZP> in(N);
+  std::mt19937 rng(P);
+  std::uniform_int_distribution<uint64_t> runif(0, P - 1);
+  for (auto &v : in)
+    v = runif(rng);
+  in[0] = 0;
+  in[1] = P / 2;
+  in[2] = P / 2 + 1;
+  in[3] = P - 1;
+
+  std::vector<Int> out(N);
+  to_symmetric(in.data(), out.data(), N);
+  for (size_t i = 0; i < N; ++i) {
+    CHECK(2 * int64_t(out[i]) > -int64_t(P));
+    CHECK(2 * int64_t(out[i]) <= int64_t(P));
+    CHECK((int64_t(out[i]) + int64_t(P)) % int64_t(P) ==
+          int64_t(in[i].value()));
+  }
+  // Round trip
+  std::vector<ZP> back(N);
+  fit(out.data(), back.data(), N);
+  for (size_t i = 0; i < N; ++i)
+    CHECK(back[i] == in[i]);
+}
+
+TEST_CASE("Symmetric") {
+  check_symmetric<int16_t, 13>();
+  check_symmetric<int32_t, 13>();
+  check_symmetric<int16_t, 32749>();
+  check_symmetric<int32_t, 32749>();
+  check_symmetric<int64_t, 32749>();
+  check_symmetric<int32_t, 2147483647>();
+  check_symmetric<int64_t, 2147483647>();
+}
@@ -0,0 +1,141 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <zp_eliminator/echelon.hpp>
+#include <zp_eliminator/random.hpp>
+
+#include "random_matrix.hpp"
+
+#include <vector>
+
+using namespace zp;
+
+const uint16_t P = 32749;
+using ZP = ZpScalar<P>;
+
+void check_rref(const EchelonBasis<P> &basis) {
+  for (int i = 0; i < basis.rank(); ++i)
+    for (int j = 0; j < basis.rank(); ++j)
+      CHECK(basis.row(j)[basis.pivot(i)] == ZP(i == j));
+}
+
+TEST_CASE("Insert") {
+  for (int cols : {1, 7, 40}) {
+    const int dim = cols / 2 + 1;
+    const size_t count = 3 * cols;
+    const auto rows = random_matrix<P>(count, cols, dim, cols);
+
+    EchelonBasis<P> basis(cols);
+    int inserted = 0;
+    for (size_t r = 0; r < count; ++r)
+      inserted += basis.insert(rows.data() + r * cols);
+    CHECK(inserted == dim);
+    CHECK(basis.rank() == dim);
+    check_rref(basis);
+
+    // Every input row is in the span
+    std::vector<ZP> row(cols);
+    for (size_t r = 0; r < count; ++r) {
+      std::copy(rows.begin() + r * cols, rows.begin() + (r + 1) * cols,
+                row.begin());
+      CHECK_FALSE(basis.reduce(row.data()));
+    }
+  }
+}
+
+TEST_CASE("InsertBatch") {
+  const int cols = 70;
+  const size_t count = 500;
+  const int dim = 45;
+  const auto rows = random_matrix<P>(count, cols, dim, 1);
+
+  EchelonBasis<P> single(cols), batched(cols);
+  for (size_t r = 0; r < count; ++r)
+    single.insert(rows.data() + r * cols);
+  // Uneven batch sizes
+  size_t first = 0;
+  int increase = 0;
+  for (size_t size : {1, 3, 40, 100, 356}) {
+    increase += batched.insert(rows.data() + first * cols, size);
+    first += size;
+  }
+  CHECK(first == count);
+  CHECK(increase == dim);
+  REQUIRE(batched.rank() == single.rank());
+  check_rref(batched);
+  // Reduced row echelon form is unique up to row order
+  for (int i = 0; i < batched.rank(); ++i) {
+    int j = 0;
+    while (single.pivot(j) != batched.pivot(i))
+      ++j;
+    for (int c = 0; c < cols; ++c)
+      CHECK(single.row(j)[c] == batched.row(i)[c]);
+  }
+}
+
+TEST_CASE("Solve") {
+  const int n = 20;
+  RandomZp<P> random(5);
+  std::vector<ZP> x(n), A(3 * n * (n + 1));
+  random.fill(x.data(), n);
+  random.fill(A.data(), A.size());
+  // Last column is the right-hand side
+  for (int r = 0; r < 3 * n; ++r) {
+    ZP sum = 0;
+    for (int c = 0; c < n; ++c)
+      sum += A[r * (n + 1) + c] * x[c];
+    A[r * (n + 1) + n] = sum;
+  }
+
+  EchelonBasis<P> basis(n + 1);
+  std::vector<ZP> solution(n);
+  for (int r = 0; r < 3 * n; ++r) {
+    basis.insert(A.data() + r * (n + 1));
+    REQUIRE(basis.solve(solution.data()));
+    if (basis.rank() == n) {
+      for (int c = 0; c < n; ++c)
+        CHECK(solution[c] == x[c]);
+    }
+  }
+  CHECK(basis.rank() == n);
+
+  // Inconsistent equation 0 = 1
+  std::vector<ZP> bad(n + 1, ZP(0));
+  bad[n] = 1;
+  CHECK(basis.insert(bad.data()));
+  CHECK_FALSE(basis.solve(solution.data()));
+}
+
+TEST_CASE("Insert_32bit") {
+  const uint64_t Q = 2147483647;
+  using ZQ = ZpScalar<Q>;
+  const int cols = 12;
+  std::vector<ZQ> rows(3 * cols * cols);
+  RandomZp<Q>(3).fill(rows.data(), rows.size());
+  // Row 2k + 1 duplicates row 2k
+  for (int r = 1; r < 3 * cols; r += 2)
+    std::copy(rows.begin() + (r - 1) * cols, rows.begin() + r * cols,
+              rows.begin() + r * cols);
+  EchelonBasis<Q> basis(cols);
+  CHECK(basis.insert(rows.data(), 2 * cols) == cols);
+}
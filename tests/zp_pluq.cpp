@@ -0,0 +1,236 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <zp_eliminator/echelon.hpp>
+#include <zp_eliminator/pluq.hpp>
+#include <zp_eliminator/random.hpp>
+
+#include "random_matrix.hpp"
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace zp;
+
+const uint16_t P = 32749;
+using ZP = ZpScalar<P>;
+
+// Random matrix of a given rank with a zero row and a zero column when the
+// rank allows it
+template <uint64_t prime>
+std::vector<ZpScalar<prime>>
+sparse_random_matrix(int rows, int cols, int rank, uint64_t stream) {
+  auto a = random_matrix<prime>(rows, cols, rank, stream);
+  if (rows > rank)
+    std::fill_n(a.begin() + rows / 2 * cols, cols, ZpScalar<prime>(0));
+  if (cols > rank)
+    for (int i = 0; i < rows; ++i)
+      a[i * cols + cols / 3] = 0;
+  return a;
+}
+
+// Greedy rank profile: indices of vectors that increase the rank
+template <uint64_t prime>
+std::vector<int> rank_profile(const std::vector<ZpScalar<prime>> &vectors,
+                              int count, int size) {
+  EchelonBasis<prime> basis(size);
+  std::vector<int> profile;
+  for (int i = 0; i < count; ++i)
+    if (basis.insert(vectors.data() + i * size))
+      profile.push_back(i);
+  return profile;
+}
+
+template <uint64_t prime>
+void check_factorization(const std::vector<ZpScalar<prime>> &a, int rows,
+                         int cols, int rank) {
+  using Zp = ZpScalar<prime>;
+  auto lu = a;
+  PLUQ<prime> f(lu.data(), rows, cols);
+  REQUIRE(f.rank() == rank);
+
+  // A = P L U Q
+  const auto &p = f.row_permutation();
+  const auto &q = f.col_permutation();
+  for (int i = 0; i < rows; ++i)
+    for (int j = 0; j < cols; ++j) {
+      Zp sum = 0;
+      for (int k = 0; k < rank; ++k)
+        sum += f.L(i, k) * f.U(k, j);
+      CHECK(sum == a[p[i] * cols + q[j]]);
+    }
+  for (int k = 0; k < rank; ++k)
+    CHECK(f.U(k, k) != Zp(0));
+
+  std::vector<Zp> transposed(cols * rows);
+  for (int i = 0; i < rows; ++i)
+    for (int j = 0; j < cols; ++j)
+      transposed[j * rows + i] = a[i * cols + j];
+  CHECK(f.row_rank_profile() == rank_profile<prime>(a, rows, cols));
+  CHECK(f.column_rank_profile() ==
+        rank_profile<prime>(transposed, cols, rows));
+
+  // Nullspaces are annihilated by A and have full rank
+  const auto kernel = f.nullspace();
+  REQUIRE(kernel.size() == size_t(cols - rank) * cols);
+  for (int v = 0; v < cols - rank; ++v)
+    for (int i = 0; i < rows; ++i) {
+      Zp sum = 0;
+      for (int j = 0; j < cols; ++j)
+        sum += a[i * cols + j] * kernel[v * cols + j];
+      CHECK(sum == Zp(0));
+    }
+  CHECK(rank_profile<prime>(kernel, cols - rank, cols).size() ==
+        size_t(cols - rank));
+
+  const auto left = f.left_nullspace();
+  REQUIRE(left.size() == size_t(rows - rank) * rows);
+  for (int v = 0; v < rows - rank; ++v)
+    for (int j = 0; j < cols; ++j) {
+      Zp sum = 0;
+      for (int i = 0; i < rows; ++i)
+        sum += left[v * rows + i] * a[i * cols + j];
+      CHECK(sum == Zp(0));
+    }
+  CHECK(rank_profile<prime>(left, rows - rank, rows).size() ==
+        size_t(rows - rank));
+}
+
+template <uint64_t prime>
+void check_factorization(int rows, int cols, int rank) {
+  const auto a =
+      sparse_random_matrix<prime>(rows, cols, rank, rows * 1000 + cols);
+  check_factorization<prime>(a, rows, cols, rank);
+}
+
+TEST_CASE("Factorization") {
+  for (auto [rows, cols, rank] :
+       std::vector<std::array<int, 3>>{{1, 1, 1},
+                                       {5, 5, 5},
+                                       {5, 5, 3},
+                                       {8, 20, 8},
+                                       {20, 8, 8},
+                                       {40, 33, 17},
+                                       {33, 70, 30},
+                                       {70, 70, 69}}) {
+    check_factorization<P>(rows, cols, rank);
+    check_factorization<2147483647>(rows, cols, rank);
+  }
+}
+
+TEST_CASE("Sparse") {
+  // Mostly zero matrices over a small prime: pivots need column transpositions
+  // and the rank profiles are not prefixes
+  const uint16_t Q = 7;
+  std::mt19937 rng;
+  std::uniform_int_distribution<int> runif(1, Q - 1);
+  std::bernoulli_distribution nonzero(0.15);
+  int row_gaps = 0, col_gaps = 0;
+  for (auto [rows, cols] : std::vector<std::array<int, 2>>{
+           {6, 6}, {9, 14}, {14, 9}, {30, 30}}) {
+    for (int it = 0; it < 16; ++it) {
+      std::vector<ZpScalar<Q>> a(rows * cols, ZpScalar<Q>(0));
+      for (auto &v : a)
+        if (nonzero(rng))
+          v = runif(rng);
+      const auto profile = rank_profile<Q>(a, rows, cols);
+      const int rank = profile.size();
+      check_factorization<Q>(a, rows, cols, rank);
+
+      PLUQ<Q> f(a.data(), rows, cols);
+      const auto col_profile = f.column_rank_profile();
+      row_gaps += rank && profile.back() != rank - 1;
+      col_gaps += rank && col_profile.back() != rank - 1;
+    }
+  }
+  CHECK(row_gaps > 0);
+  CHECK(col_gaps > 0);
+}
+
+TEST_CASE("Zero") {
+  std::vector<ZP> a(12, ZP(0));
+  PLUQ<P> f(a.data(), 3, 4);
+  CHECK(f.rank() == 0);
+  CHECK(f.row_rank_profile().empty());
+  CHECK(f.nullspace().size() == 16);
+  CHECK(f.left_nullspace().size() == 9);
+}
+
+TEST_CASE("Solve") {
+  const int rows = 30, cols = 40, rank = 25;
+  const auto a = sparse_random_matrix<P>(rows, cols, rank, 3);
+  std::vector<ZP> x0(cols), b(rows, ZP(0)), x(cols);
+  RandomZp<P>(4).fill(x0.data(), cols);
+  for (int i = 0; i < rows; ++i)
+    for (int j = 0; j < cols; ++j)
+      b[i] += a[i * cols + j] * x0[j];
+
+  auto lu = a;
+  PLUQ<P> f(lu.data(), rows, cols);
+  REQUIRE(f.solve(b.data(), x.data()));
+  for (int i = 0; i < rows; ++i) {
+    ZP sum = 0;
+    for (int j = 0; j < cols; ++j)
+      sum += a[i * cols + j] * x[j];
+    CHECK(sum == b[i]);
+  }
+
+  // Right-hand side outside of the column space
+  b[f.row_permutation()[rank]] += 1;
+  CHECK_FALSE(f.solve(b.data(), x.data()));
+}
+
+TEST_CASE("Determinant") {
+  // Leibniz formula for small matrices
+  const int n = 5;
+  for (int rank : {5, 4}) {
+    auto a = sparse_random_matrix<P>(n, n, rank, rank);
+    std::array<int, n> sigma;
+    std::iota(sigma.begin(), sigma.end(), 0);
+    ZP expected = 0;
+    do {
+      int inversions = 0;
+      for (int i = 0; i < n; ++i)
+        for (int j = i + 1; j < n; ++j)
+          inversions += sigma[i] > sigma[j];
+      ZP term = inversions % 2 ? -ZP(1) : ZP(1);
+      for (int i = 0; i < n; ++i)
+        term *= a[i * n + sigma[i]];
+      expected += term;
+    } while (std::next_permutation(sigma.begin(), sigma.end()));
+
+    PLUQ<P> f(a.data(), n, n);
+    CHECK(f.determinant() == expected);
+    CHECK((f.determinant() == ZP(0)) == (rank < n));
+  }
+
+  // Swapping two rows flips the sign
+  const int m = 50;
+  auto a = sparse_random_matrix<P>(m, m, m, 7);
+  auto b = a;
+  std::swap_ranges(b.begin(), b.begin() + m, b.begin() + 3 * m);
+  PLUQ<P> fa(a.data(), m, m), fb(b.data(), m, m);
+  CHECK(fa.determinant() != ZP(0));
+  CHECK(fa.determinant() == -fb.determinant());
+}
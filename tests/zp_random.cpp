@@ -0,0 +1,124 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <zp_eliminator/random.hpp>
+
+#include <vector>
+
+using namespace zp;
+
+TEST_CASE("Philox_KnownAnswer") {
+  // Known-answer tests of the Random123 reference implementation
+  const Philox4x32 zero(0);
+  const Philox4x32::Block r0 = zero({0, 0, 0, 0});
+  const Philox4x32::Block e0 = {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8};
+  CHECK(r0 == e0);
+
+  const Philox4x32 ones(~uint64_t(0));
+  const Philox4x32::Block r1 =
+      ones({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff});
+  const Philox4x32::Block e1 = {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd};
+  CHECK(r1 == e1);
+}
+
+TEST_CASE("Philox_Vector") {
+  const Philox4x32 philox(0x0123456789abcdef);
+  __m256i ctr[4];
+  for (int w = 0; w < 4; ++w)
+    ctr[w] = _mm256_setr_epi32(w, w + 10, w + 20, w + 30, w + 40, w + 50,
+                               w + 60, w + 70);
+  philox(ctr);
+  uint32_t lanes[4][8];
+  for (int w = 0; w < 4; ++w)
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes[w]), ctr[w]);
+  for (uint32_t l = 0; l < 8; ++l) {
+    const auto expected =
+        philox({l * 10, l * 10 + 1, l * 10 + 2, l * 10 + 3});
+    for (int w = 0; w < 4; ++w)
+      CHECK(lanes[w][l] == expected[w]);
+  }
+}
+
+template <uint64_t P> void check_fill() {
+  using Random = RandomZp<P>;
+  using ZP = typename Random::Zp;
+  const size_t N = 10000;
+  std::vector<ZP> filled(N), sequential(N);
+
+  Random random(42);
+  random.fill(filled.data(), N);
+  CHECK(random.tell() == N);
+
+  Random scalar(42);
+  for (auto &v : sequential)
+    v = scalar();
+  for (size_t i = 0; i < N; ++i) {
+    CHECK(filled[i] == sequential[i]);
+    CHECK(filled[i].value() < P);
+  }
+
+  // Unaligned seek & fill produce the same subsequence
+  for (size_t offset : {1, 31, 32, 77}) {
+    std::vector<ZP> part(N - offset - 5);
+    Random seeked(42, offset);
+    seeked.fill(part.data(), part.size());
+    for (size_t i = 0; i < part.size(); ++i)
+      CHECK(part[i] == filled[offset + i]);
+  }
+
+  // Different streams differ
+  Random other(43);
+  std::vector<ZP> other_filled(N);
+  other.fill(other_filled.data(), N);
+  size_t equal = 0;
+  for (size_t i = 0; i < N; ++i)
+    equal += other_filled[i] == filled[i];
+  CHECK(equal < 2 * N / P + 10);
+}
+
+TEST_CASE("Fill") {
+  check_fill<13>();
+  check_fill<32749>();
+  check_fill<65521>();
+  // Rejection rate is (2^32 mod p) / 2^32: ~5e-10 for 2^31 - 1, ~1/4 for
+  // 1073741827 and ~1/3 for 1431655777, the smallest prime above 2^32 / 3 and
+  // the worst case for primes below 2^31
+  check_fill<2147483647>();
+  check_fill<1073741827>();
+  check_fill<1431655777>();
+}
+
+TEST_CASE("Uniformity") {
+  const uint64_t P = 13;
+  const size_t N = 13 * 100000;
+  std::vector<ZpScalar<P>> values(N);
+  RandomZp<P>(7).fill(values.data(), N);
+  std::vector<size_t> counts(P);
+  for (const auto &v : values)
+    ++counts[v.value()];
+  // Chi-square statistic with 12 degrees of freedom, p-value ~ 1e-6
+  double chi2 = 0;
+  for (size_t c : counts)
+    chi2 += (c - 100000.) * (c - 100000.) / 100000.;
+  CHECK(chi2 < 50);
+}
@@ -204,3 +204,171 @@ TEST_CASE("Z13_Mul_MulDirect2") {
       CHECK(ImulJ.value() == (i * j) % 13);
     }
 }
+
+TEST_CASE("Z13_Mul_Auto") {
+  for (int i = 0; i < 13; ++i)
+    for (int j = 0; j < 13; ++j) {
+      const ZP13 I(i), J(j);
+      const ZP13 ImulJ = I.operator*<MulAlgo::Auto>(J);
+      CHECK(ImulJ.value() == (i * j) % 13);
+    }
+}
+
+#ifndef ZP_ELIMINATOR_TUNED_MUL_HEADER
+// Choices of the cost model, measured winners are in tools/zp_autotune output
+static_assert(auto_mul_algo<uint16_t, 13>() == MulAlgo::MulShiftDirect);
+static_assert(auto_mul_algo<uint16_t, 32749>() == MulAlgo::MulShiftDirect);
+static_assert(auto_mul_algo<uint32_t, 65521>() == MulAlgo::MulShift);
+static_assert(auto_mul_algo<uint32_t, 2147483647>() == MulAlgo::MulShift);
+// Division by constant without compiler fix-up
+static_assert(auto_mul_algo<uint32_t, 1073741827>() == MulAlgo::Explicit);
+#endif
+
+TEST_CASE("Z32749_Mul_Auto") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<int> runif(0, 32748);
+  for (int it = 0; it < 32749; ++it) {
+    const int i = runif(rng);
+    const int j = runif(rng);
+    const ZP32749 I(i), J(j);
+    const ZP32749 ImulJ = I.operator*<MulAlgo::Auto>(J);
+    CHECK(ImulJ.value() == (i * j) % 32749);
+  }
+}
+
+using ZP2147483647 = ZpScalar<2147483647>;
+TEST_CASE("Z2147483647_Mul_Auto") {
+  static_assert(sizeof(ZP2147483647::Word) == 4);
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint32_t> runif(0, 2147483646);
+  for (int it = 0; it < 32749; ++it) {
+    const uint32_t i = runif(rng);
+    const uint32_t j = runif(rng);
+    const ZP2147483647 I(i), J(j);
+    const ZP2147483647 ImulJ = I * J;
+    CHECK(ImulJ.value() == uint64_t(i) * j % 2147483647);
+  }
+}
+
+TEST_CASE("Z2147483647_Mul_MulShift") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint32_t> runif(0, 2147483646);
+  for (int it = 0; it < 32749; ++it) {
+    const uint32_t i = runif(rng);
+    const uint32_t j = runif(rng);
+    const ZP2147483647 I(i), J(j);
+    const ZP2147483647 ImulJ = I.operator*<MulAlgo::MulShift>(J);
+    CHECK(ImulJ.value() == uint64_t(i) * j % 2147483647);
+  }
+}
+
+TEST_CASE("Z2147483647_Mul_MulShiftDirect2") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint32_t> runif(0, 2147483646);
+  for (int it = 0; it < 32749; ++it) {
+    const uint32_t i = runif(rng);
+    const uint32_t j = runif(rng);
+    const ZP2147483647 I(i), J(j);
+    const ZP2147483647 ImulJ = I.operator*<MulAlgo::MulShiftDirect2>(J);
+    CHECK(ImulJ.value() == uint64_t(i) * j % 2147483647);
+  }
+}
+
+TEST_CASE("Z13_Add_Branchless") {
+  for (int i = 0; i < 13; ++i)
+    for (int j = 0; j < 13; ++j) {
+      const ZP13 I(i), J(j);
+      const ZP13 IplusJ = I.operator+<PlusMinusAlgo::Branchless>(J);
+      CHECK(IplusJ.value() == (i + j) % 13);
+    }
+}
+
+TEST_CASE("Z13_Sub_Branchless") {
+  for (int i = 0; i < 13; ++i)
+    for (int j = 0; j < 13; ++j) {
+      const ZP13 I(i), J(j);
+      const ZP13 IminusJ = I.operator-<PlusMinusAlgo::Branchless>(J);
+      CHECK(IminusJ.value() == (i + 13 - j) % 13);
+    }
+}
+
+// Constant-time policy
+using CT32749 = ConstantTimeZpScalar<32749>;
+TEST_CASE("CT32749_AddSubNeg") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<int> runif(0, 32748);
+  for (int it = 0; it < 32749; ++it) {
+    const int i = it ? runif(rng) : 0;
+    const int j = runif(rng);
+    const CT32749 I(i), J(j);
+    CHECK((I + J).value() == (i + j) % 32749);
+    CHECK((I - J).value() == (i + 32749 - j) % 32749);
+    CHECK((-I).value() == (32749 - i) % 32749);
+  }
+}
+
+TEST_CASE("CT32749_Inv") {
+  for (int i = 1; i < 32749; ++i) {
+    const CT32749 I(i);
+    CHECK((I * I.inverse()).value() == 1);
+    CHECK(I.inverse() == CT32749(ZP32749(i).inverse().value()));
+  }
+}
+
+using CT2147483647 = ConstantTimeZpScalar<2147483647>;
+TEST_CASE("CT2147483647_Arith") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint32_t> runif(0, 2147483646);
+  for (int it = 0; it < 4096; ++it) {
+    const uint32_t i = runif(rng);
+    const uint32_t j = runif(rng);
+    const CT2147483647 I(i), J(j);
+    CHECK((I + J).value() == (uint64_t(i) + j) % 2147483647);
+    CHECK((I - J).value() == (uint64_t(i) + 2147483647 - j) % 2147483647);
+    if (i)
+      CHECK((I * I.inverse()).value() == 1);
+  }
+}
+
+ZP32749 naive_pow(ZP32749 x, uint64_t e) {
+  ZP32749 res(1);
+  for (uint64_t i = 0; i < e; ++i)
+    res *= x;
+  return res;
+}
+
+TEST_CASE("Z32749_Pow") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<int> runif(0, 32748);
+  std::uniform_int_distribution<uint64_t> rexp(0, 100000);
+  for (int it = 0; it < 256; ++it) {
+    const ZP32749 x(runif(rng));
+    const uint64_t e = it < 64 ? it : rexp(rng);
+    CHECK(x.pow(e) == naive_pow(x, e));
+    CHECK(x.pow(make_pow_schedule(e)) == x.pow(e));
+  }
+  // Fermat's little theorem for large exponents
+  for (int it = 1; it < 256; ++it) {
+    const ZP32749 x(runif(rng) + 1);
+    const uint64_t k = rexp(rng) * 1000003;
+    CHECK(x.pow(k * 32748) == ZP32749(1));
+    CHECK(x.pow(k * 32748 + 5) == naive_pow(x, 5));
+  }
+  CHECK(ZP32749(0).pow(0) == ZP32749(1));
+  CHECK(ZP32749(0).pow(7) == ZP32749(0));
+}
+
+TEST_CASE("Z32749_PowConst") {
+  std::mt19937 rng;
+  std::uniform_int_distribution<int> runif(0, 32748);
+  for (int it = 0; it < 1024; ++it) {
+    const ZP32749 x(runif(rng));
+    CHECK(x.pow<0>() == ZP32749(1));
+    CHECK(x.pow<1>() == x);
+    CHECK(x.pow<2>() == x * x);
+    CHECK(x.pow<16>() == x.pow(16));
+    CHECK(x.pow<1000>() == x.pow(1000));
+    CHECK(x.pow<32747>() == x.pow(32747));
+    CHECK(x.pow<0xfedcba9876543210>() == x.pow(0xfedcba9876543210));
+  }
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#ifndef ZP_ELIMINATOR_INSTRUMENTATION
+#define ZP_ELIMINATOR_INSTRUMENTATION
+#endif
+#include <zp_eliminator/stats.hpp>
+#include <zp_eliminator/vector_kernels.hpp>
+#include <zp_eliminator/zp_scalar.hpp>
+
+#include <string>
+
+using namespace zp;
+
+using ZP13 = ZpScalar<13>;
+TEST_CASE("Count_Scalar") {
+  Stats stats;
+  {
+    StatsScope scope(stats);
+    const ZP13 a(3), b(5);
+    const ZP13 c = a + b;
+    const ZP13 d = c - a;
+    const ZP13 e = d * b;
+    const ZP13 f = e.inverse();
+    const ZP13 g = ZP13::Fit(100);
+    CHECK(f * e == ZP13(1));
+    CHECK(g == ZP13(9));
+  }
+  CHECK(stats.count(Counter::Add) == 1);
+  CHECK(stats.count(Counter::Sub) == 1);
+  CHECK(stats.count(Counter::Inversion) == 1);
+  CHECK(stats.count(Counter::Reduction) == 1);
+  // inverse() is implemented via multiplications as well
+  CHECK(stats.count(Counter::Mul) > 2);
+
+  // Nothing is accounted outside of scope
+  const Stats before = stats;
+  const ZP13 h = ZP13(1) + ZP13(2);
+  CHECK(h == ZP13(3));
+  CHECK(stats.count(Counter::Add) == before.count(Counter::Add));
+}
+
+TEST_CASE("Count_Vector") {
+  const int N = 64;
+  const uint16_t P = 32749;
+  uint16_t a[N] = {}, b[N] = {}, c[N];
+  Stats stats;
+  {
+    StatsScope scope(stats);
+    VecAddOp<uint16_t, 16, P>::run(a, b, c, N);
+    VecSubOp<uint16_t, 16, P>::run(a, b, c, N);
+  }
+  CHECK(stats.count(Counter::Add) == N);
+  CHECK(stats.count(Counter::Sub) == N);
+}
+
+// Vector and compile-time exponentiation follow the same schedule
+template <uint64_t E> void check_vec_pow_count() {
+  // Two registers and a scalar tail
+  const int N = 37;
+  const uint16_t P = 32749;
+  using ZP = ZpScalar<P>;
+  ZP x[N], y[N];
+  for (int i = 0; i < N; ++i)
+    x[i] = i + 2;
+  Stats vector, scalar;
+  {
+    StatsScope scope(vector);
+    VecPowOp<uint16_t, 16, P>::run(x, E, y, N);
+  }
+  {
+    StatsScope scope(scalar);
+    for (int i = 0; i < N; ++i)
+      y[i] = x[i].template pow<E>();
+  }
+  CHECK(vector.count(Counter::Mul) == scalar.count(Counter::Mul));
+}
+
+TEST_CASE("Count_VecPow") {
+  check_vec_pow_count<0>();
+  check_vec_pow_count<1>();
+  check_vec_pow_count<2>();
+  check_vec_pow_count<5>();
+  check_vec_pow_count<1000>();
+  check_vec_pow_count<32747>();
+}
+
+TEST_CASE("Nested_Scopes") {
+  Stats outer, inner;
+  {
+    StatsScope outer_scope(outer);
+    count(Counter::Add);
+    {
+      StatsScope inner_scope(inner);
+      count(Counter::Add, 2);
+    }
+    count(Counter::Add);
+  }
+  CHECK(outer.count(Counter::Add) == 2);
+  CHECK(inner.count(Counter::Add) == 2);
+
+  outer += inner;
+  CHECK(outer.count(Counter::Add) == 4);
+  outer.reset();
+  CHECK(outer.count(Counter::Add) == 0);
+}
+
+TEST_CASE("Phase_Timer") {
+  Stats stats;
+  {
+    StatsScope scope(stats);
+    for (int i = 0; i < 3; ++i) {
+      PhaseTimer timer(Phase::RowUpdate);
+    }
+  }
+  CHECK(stats.calls(Phase::RowUpdate) == 3);
+  CHECK(stats.calls(Phase::PivotSearch) == 0);
+  CHECK(stats.seconds(Phase::RowUpdate) >= 0.);
+}
+
+TEST_CASE("Json") {
+  Stats stats;
+  stats.counters[int(Counter::Mul)] = 42;
+  stats.phase_calls[int(Phase::Inversion)] = 7;
+  const std::string json = stats.json();
+  CHECK(json.find("\"mul\":42") != std::string::npos);
+  CHECK(json.find("\"inversion\":{\"calls\":7,\"ns\":0}") != std::string::npos);
+  CHECK(json.front() == '{');
+  CHECK(json.back() == '}');
+}
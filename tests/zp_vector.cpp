@@ -24,6 +24,7 @@ SOFTWARE.
 #include <zp_eliminator/vector_kernels.hpp>
 
 #include <random>
+#include <vector>
 
 using namespace zp;
 
@@ -70,3 +71,76 @@ TEST_CASE("Sub_16x16") {
     CHECK((a[i] + P - b[i]) % P == c[i]);
   }
 }
+
+template <uint16_t P> void check_mul() {
+  const int N = 1024;
+  uint16_t a[N];
+  uint16_t b[N];
+  uint16_t c[N];
+
+  std::mt19937 rng(P);
+  std::uniform_int_distribution<uint16_t> runif(0, P - 1);
+  for (int i = 0; i < N; ++i) {
+    a[i] = runif(rng);
+    b[i] = runif(rng);
+  }
+  a[0] = b[0] = P - 1;
+  a[1] = 0;
+
+  VecMulOp<uint16_t, 16, P> vmul;
+  vmul.run(a, b, c, N);
+
+  for (int i = 0; i < N; ++i) {
+    CHECK(uint32_t(a[i]) * b[i] % P == c[i]);
+  }
+}
+
+TEST_CASE("Mul_16x16") {
+  check_mul<32749>();
+  check_mul<32003>();
+  check_mul<251>();
+  check_mul<13>();
+}
+
+TEST_CASE("Pow_16x16") {
+  const int N = 1000;
+  const uint16_t P = 32749;
+  using ZP = ZpScalar<P>;
+  ZP x[N], c[N];
+
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint16_t> runif(0, P - 1);
+  for (int i = 0; i < N; ++i)
+    x[i] = runif(rng);
+
+  for (uint64_t e : {0ull, 1ull, 2ull, 3ull, 255ull, 32747ull, 1234567890123ull}) {
+    VecPowOp<uint16_t, 16, P>::run(x, e, c, N);
+    for (int i = 0; i < N; ++i)
+      CHECK(c[i] == x[i].pow(e));
+  }
+}
+
+TEST_CASE("Horner_16x16") {
+  const int N = 1000;
+  const uint16_t P = 32749;
+  using ZP = ZpScalar<P>;
+  ZP x[N], c[N];
+
+  std::mt19937 rng;
+  std::uniform_int_distribution<uint16_t> runif(0, P - 1);
+  for (int i = 0; i < N; ++i)
+    x[i] = runif(rng);
+
+  for (size_t degree : {0, 1, 5, 64}) {
+    std::vector<ZP> coeffs(degree + 1);
+    for (auto &v : coeffs)
+      v = runif(rng);
+    VecHornerOp<uint16_t, 16, P>::run(coeffs.data(), coeffs.size(), x, c, N);
+    for (int i = 0; i < N; ++i) {
+      ZP expected = 0;
+      for (size_t k = 0; k <= degree; ++k)
+        expected += coeffs[k] * x[i].pow(k);
+      CHECK(c[i] == expected);
+    }
+  }
+}
@@ -0,0 +1,179 @@
+/******************************************************************************
+Copyright (c) 2021 Dmitriy Korchemkin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+// Microbenchmarks every MulAlgo variant for a set of primes on the host CPU and
+// writes a header with tuned_mul_algo specializations, which is picked up by
+// zp_scalar.hpp when ZP_ELIMINATOR_TUNED_MUL_HEADER is defined.
+#include <zp_eliminator/zp_scalar.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef ZP_AUTOTUNE_PRIMES
+#define ZP_AUTOTUNE_PRIMES 13, 251, 32003, 32749, 65521, 2147483647
+#endif
+
+using namespace zp;
+
+namespace {
+const int N = 4096;
+const int Repeats = 64;
+const int Runs = 16;
+
+const char *name(MulAlgo algo) {
+  switch (algo) {
+  case MulAlgo::Explicit:
+    return "Explicit";
+  case MulAlgo::MulShift:
+    return "MulShift";
+  case MulAlgo::MulShiftDirect:
+    return "MulShiftDirect";
+  case MulAlgo::MulShiftDirect2:
+    return "MulShiftDirect2";
+  case MulAlgo::Auto:
+    return "Auto";
+  }
+  return "";
+}
+
+const char *name(uint16_t) { return "uint16_t"; }
+const char *name(uint32_t) { return "uint32_t"; }
+
+// Independent dependency chains per run: enough to keep the multiplier busy,
+// while every product feeds the next one, so the loop cannot be folded away
+const int Chains = 4;
+// One cycle at 5 GHz; anything faster means the work was optimized out
+const double MinPlausibleNs = 0.2;
+
+template <uint64_t P, MulAlgo algo>
+double measure(const std::vector<ZpScalar<P>> &a,
+               const std::vector<ZpScalar<P>> &b) {
+  using ZP = ZpScalar<P>;
+  using Clock = std::chrono::steady_clock;
+  double best = 1e300;
+  volatile typename ZP::Word sink = 0;
+  for (int run = 0; run < Runs; ++run) {
+    ZP x[Chains];
+    for (int c = 0; c < Chains; ++c)
+      x[c] = a[(run * Chains + c) % N];
+    const auto start = Clock::now();
+    for (int rep = 0; rep < Repeats; ++rep)
+      for (int i = 0; i < N; i += Chains)
+        for (int c = 0; c < Chains; ++c)
+          x[c] = x[c].template operator*<algo>(b[i + c]);
+    const auto stop = Clock::now();
+    for (int c = 0; c < Chains; ++c)
+      sink = sink ^ x[c].value();
+    best = std::min(best,
+                    std::chrono::duration<double, std::nano>(stop - start)
+                        .count());
+  }
+  return best / (double(N) * Repeats);
+}
+
+template <uint64_t P> void tune_prime(std::ostream &header) {
+  using ZP = ZpScalar<P>;
+  using Word = typename ZP::Word;
+  using DWord = dword_type_t<Word>;
+  std::mt19937 rng(P);
+  // Non-zero factors, so that the chains never collapse to zero
+  std::uniform_int_distribution<uint64_t> runif(1, P - 1);
+  std::vector<ZP> a(N), b(N);
+  for (int i = 0; i < N; ++i) {
+    a[i] = Word(runif(rng));
+    b[i] = Word(runif(rng));
+  }
+
+  std::vector<std::pair<double, MulAlgo>> timings;
+  timings.emplace_back(measure<P, MulAlgo::Explicit>(a, b), MulAlgo::Explicit);
+  timings.emplace_back(measure<P, MulAlgo::MulShift>(a, b), MulAlgo::MulShift);
+  if constexpr (sizeof(Word) == 2)
+    timings.emplace_back(measure<P, MulAlgo::MulShiftDirect>(a, b),
+                         MulAlgo::MulShiftDirect);
+  if constexpr (direct_mod_trait<Word, P, DWord(P) * (P - 1)>::Valid)
+    timings.emplace_back(measure<P, MulAlgo::MulShiftDirect2>(a, b),
+                         MulAlgo::MulShiftDirect2);
+
+  std::cerr << "p = " << P << ":";
+  for (const auto &[time, algo] : timings)
+    std::cerr << " " << name(algo) << " " << time << "ns"
+              << (time < MinPlausibleNs ? " (implausible, ignored)" : "");
+  timings.erase(std::remove_if(timings.begin(), timings.end(),
+                               [](const auto &timing) {
+                                 return timing.first < MinPlausibleNs;
+                               }),
+                timings.end());
+  if (timings.empty()) {
+    std::cerr << " -> no reliable timings, keeping the cost model" << std::endl;
+    return;
+  }
+  const auto best = *std::min_element(timings.begin(), timings.end());
+  std::cerr << " -> " << name(best.second)
+            << " (cost model: " << name(auto_mul_algo<Word, P>()) << ")"
+            << std::endl;
+
+  header << "template <> struct tuned_mul_algo<" << name(Word()) << ", " << P
+         << "> {\n"
+         << "  static constexpr bool Available = true;\n"
+         << "  static constexpr MulAlgo value = MulAlgo::" << name(best.second)
+         << ";\n"
+         << "};\n";
+}
+
+template <uint64_t P> void tune(std::ostream &header) {
+  // Wider primes need 64-bit words, which ZpScalar does not support
+  constexpr bool supported = P <= integer_traits<uint32_t>::MaxScalar;
+  static_assert(supported,
+                "ZP_AUTOTUNE_PRIMES: only primes up to 2^31-1 are supported");
+  if constexpr (supported)
+    tune_prime<P>(header);
+}
+
+template <uint64_t... Primes> void tune_all(std::ostream &header) {
+  header << "// Generated by zp_autotune, do not edit\n"
+         << "#ifndef ZP_TUNED_MUL_ALGO_HPP\n"
+         << "#define ZP_TUNED_MUL_ALGO_HPP\n\n"
+         << "#include \"zp_eliminator/zp_scalar.hpp\"\n\n"
+         << "namespace zp {\n";
+  (tune<Primes>(header), ...);
+  header << "} // namespace zp\n\n#endif\n";
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 2) {
+    std::cerr << "Usage: " << argv[0] << " [output header]" << std::endl;
+    return 1;
+  }
+  if (argc == 1) {
+    tune_all<ZP_AUTOTUNE_PRIMES>(std::cout);
+    return 0;
+  }
+  std::ofstream header(argv[1]);
+  tune_all<ZP_AUTOTUNE_PRIMES>(header);
+  return header ? 0 : 1;
+}